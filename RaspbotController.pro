@@ -11,13 +11,19 @@ TARGET = RaspbotController
 TEMPLATE = app
 
 SOURCES += \
+    clocksync.cpp \
+    linkquality.cpp \
     main.cpp \
     mainwindow.cpp \
+    obstacleguard.cpp \
     raspbotclient.cpp
 
 HEADERS += \
+    clocksync.h \
     commandprotocol.h \
+    linkquality.h \
     mainwindow.h \
+    obstacleguard.h \
     raspbotclient.h
 
 FORMS += \
@@ -0,0 +1,33 @@
+QT       += core gui network testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++17 testcase
+
+# 벤치마크는 최적화 빌드에서만 의미가 있습니다.
+CONFIG -= debug
+CONFIG += release
+
+TARGET = tst_raspbotbenchmark
+TEMPLATE = app
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    tst_raspbotbenchmark.cpp \
+    ../clocksync.cpp \
+    ../linkquality.cpp \
+    ../mainwindow.cpp \
+    ../obstacleguard.cpp \
+    ../raspbotclient.cpp
+
+HEADERS += \
+    ../clocksync.h \
+    ../commandprotocol.h \
+    ../linkquality.h \
+    ../mainwindow.h \
+    ../obstacleguard.h \
+    ../raspbotclient.h
+
+FORMS += \
+    ../mainwindow.ui
@@ -0,0 +1,352 @@
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextEdit>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+#include "commandprotocol.h"
+#include "mainwindow.h"
+#include "raspbotclient.h"
+#include "ui_mainwindow.h"
+
+/**
+ * 명령어 생성, 수신 프레이밍, 응답 파싱, 모터 제어 갱신 전송, 장애물 판단 경로의 마이크로 벤치마크입니다.
+ * 각 케이스는 QBENCHMARK 결과와 함께 연산당 할당 횟수를 출력합니다.
+ *
+ *   qmake benchmarks/benchmarks.pro && make && ./tst_raspbotbenchmark
+ */
+
+namespace {
+
+std::atomic<quint64> g_allocations{0};
+// 클라이언트 스레드 등 다른 스레드의 할당이 섞이지 않도록 측정 스레드에서만 켭니다.
+thread_local bool g_countAllocations = false;
+
+inline void countAllocation() {
+    if (g_countAllocations) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+// Qt 컨테이너는 malloc을 직접 사용하므로 operator new가 아닌 malloc 계열을 가로챕니다.
+// (operator new도 내부적으로 malloc을 호출하므로 함께 집계됩니다.)
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) noexcept {
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) noexcept {
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) noexcept {
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+}
+#else
+void *operator new(std::size_t size) {
+    countAllocation();
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+#endif
+
+namespace {
+
+// QBENCHMARK 블록 안에서 반복 횟수를 세어 연산당 할당 횟수를 계산합니다.
+class AllocationCounter {
+public:
+    explicit AllocationCounter(int operationsPerIteration = 1)
+        : m_operationsPerIteration(operationsPerIteration), m_iterations(0) {
+        m_start = g_allocations.load();
+        g_countAllocations = true;
+    }
+
+    ~AllocationCounter() {
+        g_countAllocations = false;
+        if (m_iterations == 0) return;
+        double perOperation = static_cast<double>(g_allocations.load() - m_start)
+                              / (static_cast<double>(m_iterations) * m_operationsPerIteration);
+        qInfo().noquote() << QStringLiteral("%1(%2): %3 allocations/op")
+                                 .arg(QString::fromLatin1(QTest::currentTestFunction()),
+                                      QString::fromLatin1(QTest::currentDataTag()))
+                                 .arg(perOperation, 0, 'f', 2);
+    }
+
+    void tick() { ++m_iterations; }
+
+private:
+    int m_operationsPerIteration;
+    quint64 m_iterations;
+    quint64 m_start;
+};
+
+// 측정 대상이 아닌 작업 동안 할당 집계를 멈춥니다.
+class AllocationPause {
+public:
+    AllocationPause() : m_wasCounting(g_countAllocations) { g_countAllocations = false; }
+    ~AllocationPause() { g_countAllocations = m_wasCounting; }
+
+private:
+    bool m_wasCounting;
+};
+
+// 명령 전송/수신 경로의 qDebug 출력은 형식화 비용만 남기고 콘솔 출력은 버립니다.
+QtMessageHandler g_previousHandler = nullptr;
+
+void quietMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message) {
+    if (type == QtDebugMsg || type == QtWarningMsg || !g_previousHandler) return;
+    g_previousHandler(type, context, message);
+}
+
+// 거리는 150~249 cm로, 정지 거리 최댓값(100 cm)보다 항상 멀어 장애물 정지가 일어나지 않습니다.
+// (정지/해제 경로는 obstacleGuardTransition에서 따로 측정)
+QByteArray buildReplyBuffer(int lineCount) {
+    QByteArray buffer;
+    for (int i = 0; i < lineCount; ++i) {
+        buffer += QStringLiteral("{\"command\":\"READ_ULTRASONIC\",\"distance\":%1,\"timestamp\":%2}\n")
+                      .arg(150 + i % 100)
+                      .arg(1000000 + i * 1000)
+                      .toUtf8();
+    }
+    return buffer;
+}
+
+} // namespace
+
+class RaspbotBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void buildCommand_data();
+    void buildCommand();
+    void readBufferFraming_data();
+    void readBufferFraming();
+    void replyParsing_data();
+    void replyParsing();
+    void replyHandling_data();
+    void replyHandling();
+    void motorCommandDispatch();
+    void obstacleGuardTransition();
+
+private:
+    void drainPeer();
+    void stopBackgroundTimers(RaspbotClient *client);
+
+    MainWindow *m_window = nullptr;
+    RaspbotClient *m_client = nullptr; // 테스트 스레드에서 동작하는 루프백 연결 클라이언트
+    QTcpServer *m_server = nullptr;
+    QTcpSocket *m_peer = nullptr;
+};
+
+void RaspbotBenchmark::initTestCase() {
+    g_previousHandler = qInstallMessageHandler(quietMessageHandler);
+
+    m_window = new MainWindow;
+    m_window->ui->logTextEdit->document()->setMaximumBlockCount(100);
+
+    // 모터 제어 갱신 전송 경로는 실제 소켓 쓰기를 동기적으로 측정하도록
+    // 테스트 스레드에 둔 클라이언트를 루프백 서버에 연결합니다.
+    m_server = new QTcpServer(this);
+    QVERIFY(m_server->listen(QHostAddress::LocalHost));
+
+    m_client = new RaspbotClient(this);
+    m_client->connectToServer(QStringLiteral("127.0.0.1"), m_server->serverPort());
+    QTRY_VERIFY(m_client->isConnected());
+    QTRY_VERIFY(m_server->hasPendingConnections());
+    m_peer = m_server->nextPendingConnection();
+    QVERIFY(m_peer);
+    stopBackgroundTimers(m_client);
+}
+
+void RaspbotBenchmark::cleanupTestCase() {
+    m_client->disconnectFromServer();
+    delete m_window;
+    m_window = nullptr;
+    qInstallMessageHandler(g_previousHandler);
+}
+
+void RaspbotBenchmark::drainPeer() {
+    AllocationPause pause;
+    while (m_peer->waitForReadyRead(0)) {
+        m_peer->readAll();
+    }
+}
+
+// 시계 동기화, 링크 품질 평가, 센서 폴링 타이머를 멈춰 측정 중 소켓 쓰기와 할당이 끼어들지 않게 합니다.
+void RaspbotBenchmark::stopBackgroundTimers(RaspbotClient *client) {
+    client->m_syncTimer->stop();
+    client->m_linkTimer->stop();
+    client->m_sensorPollTimer->stop();
+}
+
+void RaspbotBenchmark::buildCommand_data() {
+    QTest::addColumn<int>("builder");
+
+    QTest::newRow("motor") << 0;
+    QTest::newRow("servo") << 1;
+    QTest::newRow("rgbAll") << 2;
+    QTest::newRow("rgbIndividualBrightness") << 3;
+    QTest::newRow("buzzer") << 4;
+    QTest::newRow("readUltrasonic") << 5;
+    QTest::newRow("timeSync") << 6;
+}
+
+void RaspbotBenchmark::buildCommand() {
+    QFETCH(int, builder);
+
+    const std::function<QString()> builders[] = {
+        [] { return CommandBuilder::buildMotorCommand(MotorNumber::L1, MotorDirection::FORWARD, 100); },
+        [] { return CommandBuilder::buildServoCommand(1, 90); },
+        [] { return CommandBuilder::buildRgbAllCommand(DeviceStatus::ON, RgbColor::RED); },
+        [] { return CommandBuilder::buildRgbIndividualBrightnessCommand(3, 255, 128, 0); },
+        [] { return CommandBuilder::buildBuzzerCommand(DeviceStatus::ON); },
+        [] { return CommandBuilder::buildReadUltrasonicCommand(); },
+        [] { return CommandBuilder::buildTimeSyncCommand(123456789); },
+    };
+    const std::function<QString()> &build = builders[builder];
+
+    QString command;
+    AllocationCounter counter;
+    QBENCHMARK {
+        command = build();
+        counter.tick();
+    }
+    QVERIFY(!command.isEmpty());
+}
+
+void RaspbotBenchmark::readBufferFraming_data() {
+    QTest::addColumn<int>("lineCount");
+
+    QTest::newRow("1 line") << 1;
+    QTest::newRow("10 lines") << 10;
+    QTest::newRow("100 lines") << 100;
+    QTest::newRow("1000 lines") << 1000;
+}
+
+void RaspbotBenchmark::readBufferFraming() {
+    QFETCH(int, lineCount);
+
+    RaspbotClient client;
+    const QByteArray payload = buildReplyBuffer(lineCount);
+
+    int received = 0;
+    connect(&client, &RaspbotClient::messageReceived, this, [&received]() { ++received; });
+
+    int iterations = 0;
+    AllocationCounter counter(lineCount); // 줄 하나를 연산 하나로 집계
+    QBENCHMARK {
+        client.m_readBuffer = payload;
+        client.processReadBuffer(client.clientTimeUs());
+        counter.tick();
+        ++iterations;
+    }
+    QVERIFY(client.m_readBuffer.isEmpty());
+    QCOMPARE(received, iterations * lineCount);
+    QVERIFY(!client.isObstacleStopActive());
+}
+
+void RaspbotBenchmark::replyParsing_data() {
+    QTest::addColumn<QString>("message");
+
+    QTest::newRow("ultrasonic") << QStringLiteral("{\"command\":\"READ_ULTRASONIC\",\"distance\":42,\"timestamp\":1000000}");
+    QTest::newRow("ack") << QStringLiteral("{\"endpoint\":\"/motor\",\"status\":\"ok\"}");
+    QTest::newRow("invalid") << QStringLiteral("not json");
+}
+
+void RaspbotBenchmark::replyParsing() {
+    QFETCH(QString, message);
+
+    // 위젯 갱신을 제외한 JSON 응답 파싱만 측정
+    QJsonObject reply;
+    AllocationCounter counter;
+    QBENCHMARK {
+        MainWindow::parseServerReply(message, reply);
+        counter.tick();
+    }
+}
+
+void RaspbotBenchmark::replyHandling_data() {
+    replyParsing_data();
+}
+
+void RaspbotBenchmark::replyHandling() {
+    QFETCH(QString, message);
+
+    // 로그/상태 표시줄 위젯 갱신까지 포함한 응답 처리 슬롯 전체
+    AllocationCounter counter;
+    QBENCHMARK {
+        m_window->onClientMessageReceived(message, 1000000);
+        counter.tick();
+    }
+}
+
+void RaspbotBenchmark::motorCommandDispatch() {
+    QVERIFY(m_client->isConnected());
+    drainPeer();
+
+    // 전진 제어 갱신 하나(네 모터 명령 생성 + 한 번의 소켓 쓰기)를 같은 스레드에서 동기적으로 처리
+    int iteration = 0;
+    bool written = true;
+    AllocationCounter counter;
+    QBENCHMARK {
+        written = m_client->driveMotors(MotorDirection::FORWARD, MotorDirection::FORWARD, 100) && written;
+        counter.tick();
+
+        // 루프백 수신 측이 막히지 않도록 주기적으로 비웁니다.
+        if (++iteration % 64 == 0) {
+            drainPeer();
+        }
+    }
+    QVERIFY(written);
+}
+
+void RaspbotBenchmark::obstacleGuardTransition() {
+    // 장애물 정지와 해제를 번갈아 일으키는 초음파 샘플 두 개를 판단하는 비용
+    ObstacleGuard guard;
+    guard.setPollIntervalUs(10 * 1000);
+
+    qint64 now = 1000000;
+    int transitions = 0;
+    AllocationCounter counter(2);
+    QBENCHMARK {
+        now += 1000;
+        if (guard.onUltrasonicSample(guard.stopDistanceCm() - 5, now, now) == ObstacleAction::STOP) {
+            guard.recordStopSent(now);
+            ++transitions;
+        }
+        now += 1000;
+        if (guard.onUltrasonicSample(guard.stopDistanceCm() + 50, now, now) == ObstacleAction::RELEASE) {
+            ++transitions;
+        }
+        counter.tick();
+    }
+    QVERIFY(transitions > 0);
+    QVERIFY(!guard.isTripped());
+}
+
+QTEST_MAIN(RaspbotBenchmark)
+
+#include "tst_raspbotbenchmark.moc"
@@ -0,0 +1,101 @@
+#include "clocksync.h"
+#include <limits>
+
+ClockSync::ClockSync() {
+    reset();
+}
+
+void ClockSync::reset() {
+    m_samples.clear();
+    m_filtered.clear();
+    m_synchronized = false;
+    m_offsetUs = 0;
+    m_referenceTimeUs = 0;
+    m_drift = 0.0;
+    m_lastLatency = LinkLatency();
+}
+
+bool ClockSync::addSample(qint64 t0, qint64 t1, qint64 t2, qint64 t3) {
+    const qint64 processing = t2 - t1;
+    const qint64 delay = (t3 - t0) - processing;
+    if (delay < 0 || processing < 0) {
+        return false;
+    }
+
+    Sample sample;
+    sample.clientTimeUs = t0 + (t3 - t0) / 2;
+    sample.offsetUs = ((t1 - t0) + (t2 - t3)) / 2;
+    sample.delayUs = delay;
+
+    m_samples.append(sample);
+    if (m_samples.size() > kSampleWindow) {
+        m_samples.removeFirst();
+    }
+
+    // 큐잉 지연이 가장 적은 샘플이 대칭 경로 가정에 가장 가깝습니다.
+    const Sample *best = &m_samples.first();
+    for (const Sample &s : m_samples) {
+        if (s.delayUs < best->delayUs) {
+            best = &s;
+        }
+    }
+
+    if (m_filtered.isEmpty() || m_filtered.last().clientTimeUs != best->clientTimeUs) {
+        m_filtered.append(*best);
+        if (m_filtered.size() > kDriftHistory) {
+            m_filtered.removeFirst();
+        }
+        updateDrift();
+    }
+
+    m_offsetUs = best->offsetUs;
+    m_referenceTimeUs = best->clientTimeUs;
+    m_synchronized = true;
+
+    // 필터링된 오프셋으로 이번 교환의 구간별 지연을 분리합니다.
+    LinkLatency latency;
+    latency.serverProcessingUs = processing;
+    latency.roundTripUs = delay;
+    latency.uplinkUs = qBound<qint64>(0, (t1 - offsetAt(t0)) - t0, delay);
+    latency.downlinkUs = delay - latency.uplinkUs;
+    latency.offsetUs = offsetAt(t3);
+    latency.driftPpm = driftPpm();
+    m_lastLatency = latency;
+    return true;
+}
+
+qint64 ClockSync::offsetAt(qint64 clientTimeUs) const {
+    return m_offsetUs + static_cast<qint64>(m_drift * (clientTimeUs - m_referenceTimeUs));
+}
+
+qint64 ClockSync::toClientTime(qint64 serverTimeUs) const {
+    // 드리프트 항은 매우 작으므로 서버 시각 기준으로 계산해도 오차는 무시할 수 있습니다.
+    return serverTimeUs - offsetAt(serverTimeUs - m_offsetUs);
+}
+
+void ClockSync::updateDrift() {
+    if (m_filtered.size() < 2) {
+        m_drift = 0.0;
+        return;
+    }
+    const qint64 base = m_filtered.first().clientTimeUs;
+    if (m_filtered.last().clientTimeUs - base < kMinDriftSpanUs) {
+        return;
+    }
+
+    // 오프셋 이력에 대한 최소제곱 직선의 기울기
+    double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+    const double n = m_filtered.size();
+    for (const Sample &s : m_filtered) {
+        const double x = static_cast<double>(s.clientTimeUs - base);
+        const double y = static_cast<double>(s.offsetUs);
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+    }
+    const double denominator = n * sumXX - sumX * sumX;
+    if (denominator > std::numeric_limits<double>::epsilon()) {
+        m_drift = (n * sumXY - sumX * sumY) / denominator;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+#include <QtGlobal>
+#include <QMetaType>
+#include <QVector>
+
+/**
+ * NTP 방식의 4-타임스탬프 교환으로 로봇(서버) 시계와 클라이언트 시계의
+ * 오프셋과 드리프트를 추정하는 클래스입니다.
+ *
+ *   t0: 클라이언트 요청 송신 시각 (클라이언트 시계)
+ *   t1: 서버 요청 수신 시각     (서버 시계)
+ *   t2: 서버 응답 송신 시각     (서버 시계)
+ *   t3: 클라이언트 응답 수신 시각 (클라이언트 시계)
+ *
+ * 모든 시각은 마이크로초 단위이며, 오프셋은 (서버 시각 - 클라이언트 시각)입니다.
+ *
+ * 주의: 두 시계의 오프셋과 경로 비대칭은 이 교환만으로 구분할 수 없습니다.
+ * 오프셋은 창 안의 최소 지연 샘플이 대칭 경로라고 가정해 구하므로, 그 샘플의
+ * 업링크/다운링크는 정의상 각각 지연의 절반이 됩니다. 다른 샘플의 분리 값은
+ * 그 기준 대비 어느 방향의 지연이 늘었는지를 보여주는 추정치이지,
+ * 실제로 측정한 단방향 지연이 아닙니다.
+ */
+
+// 한 번의 교환에서 분리한 구간별 지연 (마이크로초, 업링크/다운링크는 추정치)
+struct LinkLatency {
+    qint64 uplinkUs = 0;           // 클라이언트 -> 서버
+    qint64 downlinkUs = 0;         // 서버 -> 클라이언트
+    qint64 serverProcessingUs = 0; // 서버 내부 처리 시간 (t2 - t1)
+    qint64 roundTripUs = 0;        // 네트워크 왕복 시간 (처리 시간 제외)
+    qint64 offsetUs = 0;           // 추정된 시계 오프셋
+    double driftPpm = 0.0;         // 추정된 시계 드리프트 (ppm)
+};
+
+class ClockSync {
+public:
+    ClockSync();
+
+    void reset();
+
+    // 교환 결과를 추가합니다. 유효하지 않은 샘플(음수 지연)이면 false를 반환합니다.
+    bool addSample(qint64 t0, qint64 t1, qint64 t2, qint64 t3);
+
+    bool isSynchronized() const { return m_synchronized; }
+    int sampleCount() const { return m_samples.size(); }
+
+    // 주어진 클라이언트 시각에서의 오프셋 (드리프트 보정 포함)
+    qint64 offsetAt(qint64 clientTimeUs) const;
+    // 서버 시각을 클라이언트 시각으로 변환
+    qint64 toClientTime(qint64 serverTimeUs) const;
+
+    double driftPpm() const { return m_drift * 1e6; }
+    LinkLatency lastLatency() const { return m_lastLatency; }
+
+private:
+    struct Sample {
+        qint64 clientTimeUs; // 교환 중간 시점 (t0 + t3) / 2
+        qint64 offsetUs;
+        qint64 delayUs;
+    };
+
+    void updateDrift();
+
+    static constexpr int kSampleWindow = 8;   // 최소 지연 샘플 선택용 창 크기
+    static constexpr int kDriftHistory = 32;  // 드리프트 회귀용 오프셋 이력 크기
+    static constexpr qint64 kMinDriftSpanUs = 10 * 1000 * 1000; // 드리프트 추정에 필요한 최소 구간
+
+    QVector<Sample> m_samples;        // 최근 원시 샘플
+    QVector<Sample> m_filtered;       // 창별 최소 지연 샘플 이력
+    bool m_synchronized;
+    qint64 m_offsetUs;                // 기준 시점에서의 오프셋
+    qint64 m_referenceTimeUs;         // 오프셋 기준 클라이언트 시각
+    double m_drift;                   // 오프셋 변화율 (us/us)
+    LinkLatency m_lastLatency;
+};
+
+Q_DECLARE_METATYPE(LinkLatency) // 클라이언트 스레드에서 GUI로 시그널 전달
+
+#endif // CLOCKSYNC_H
@@ -117,6 +117,7 @@ public:
     }
 
     // 초음파 거리 읽기 (/ultrasonic/read 엔드포인트)
+    // 응답: {"command":"READ_ULTRASONIC","distance":<cm>,"timestamp":<서버 us>}
     static QString buildReadUltrasonicCommand() {
         QJsonObject cmd;
         cmd["endpoint"] = "/ultrasonic/read";
@@ -124,6 +125,7 @@ public:
     }
 
     // 적외선 센서 읽기 (/ir/sensor 엔드포인트)
+    // 응답: {"command":"READ_IR_SENSOR","obstacle":<bool>,"timestamp":<서버 us>}
     static QString buildReadInfraredSensorCommand() {
         QJsonObject cmd;
         cmd["endpoint"] = "/ir/sensor";
@@ -136,6 +138,16 @@ public:
         cmd["endpoint"] = "/ir/code";
         return QJsonDocument(cmd).toJson(QJsonDocument::Compact);
     }
+
+    // 시계 동기화 요청 (/time/sync 엔드포인트)
+    // 서버는 t0를 그대로 돌려주고 수신 시각 t1, 송신 시각 t2(마이크로초)를 채워
+    // {"command":"TIME_SYNC","t0":..,"t1":..,"t2":..} 형태로 응답합니다.
+    static QString buildTimeSyncCommand(qint64 t0) {
+        QJsonObject cmd;
+        cmd["endpoint"] = "/time/sync";
+        cmd["t0"] = t0;
+        return QJsonDocument(cmd).toJson(QJsonDocument::Compact);
+    }
 };
 
 #endif // COMMANDPROTOCOL_H
@@ -0,0 +1,88 @@
+#include "linkquality.h"
+#include <QtMath>
+
+LinkQuality::LinkQuality() {
+    reset();
+}
+
+void LinkQuality::reset() {
+    m_active = false;
+    m_controlRateHz = kInitialControlRateHz;
+    m_sensorRateHz = kInitialSensorRateHz;
+    m_minRttUs = 0;
+    m_smoothedRttUs = 0;
+    m_lossRate = 0.0;
+    m_previousBacklog = 0;
+    m_lossSinceLastEvaluation = false;
+    m_status = LinkStatus();
+    m_status.controlIntervalMs = controlIntervalMs();
+    m_status.sensorIntervalMs = sensorIntervalMs();
+}
+
+void LinkQuality::addRoundTrip(qint64 rttUs) {
+    m_active = true;
+    if (m_smoothedRttUs == 0) {
+        m_smoothedRttUs = rttUs;
+    } else {
+        m_smoothedRttUs += static_cast<qint64>(kSmoothing * (rttUs - m_smoothedRttUs));
+    }
+    if (m_minRttUs == 0 || rttUs < m_minRttUs) {
+        m_minRttUs = rttUs;
+    }
+}
+
+void LinkQuality::addProbeResult(bool answered) {
+    // 서버가 동기화에 응답한 적이 없다면 무응답은 손실이 아니라 미지원입니다.
+    if (!m_active) return;
+    m_lossRate += kSmoothing * ((answered ? 0.0 : 1.0) - m_lossRate);
+    if (!answered) {
+        m_lossSinceLastEvaluation = true;
+    }
+}
+
+LinkStatus LinkQuality::evaluate(qint64 writeBacklog) {
+    if (!m_active) {
+        m_previousBacklog = writeBacklog;
+        m_status.writeBacklog = writeBacklog;
+        return m_status;
+    }
+
+    bool backlogGrowing = writeBacklog > m_previousBacklog && writeBacklog > kBacklogLimit / 4;
+    bool backlogFull = writeBacklog > kBacklogLimit;
+    bool queueing = m_minRttUs > 0 && m_smoothedRttUs - m_minRttUs > kQueueingDelayLimitUs;
+    bool congested = backlogGrowing || backlogFull || queueing || m_lossSinceLastEvaluation;
+    m_previousBacklog = writeBacklog;
+    m_lossSinceLastEvaluation = false;
+
+    if (congested) {
+        m_controlRateHz = qMax(kMinControlRateHz, m_controlRateHz * kDecreaseFactor);
+        m_sensorRateHz = qMax(kMinSensorRateHz, m_sensorRateHz * kDecreaseFactor);
+    } else {
+        m_controlRateHz = qMin(kMaxControlRateHz, m_controlRateHz + kControlIncreaseHz);
+        m_sensorRateHz = qMin(kMaxSensorRateHz, m_sensorRateHz + kSensorIncreaseHz);
+    }
+
+    LinkStatus status;
+    if (m_lossRate > kBadLossRate || m_smoothedRttUs > kBadRttUs || backlogFull) {
+        status.health = LinkHealth::BAD;
+    } else if (congested) {
+        status.health = LinkHealth::DEGRADED;
+    } else {
+        status.health = LinkHealth::GOOD;
+    }
+    status.smoothedRttUs = m_smoothedRttUs;
+    status.lossRate = m_lossRate;
+    status.writeBacklog = writeBacklog;
+    status.controlIntervalMs = controlIntervalMs();
+    status.sensorIntervalMs = sensorIntervalMs();
+    m_status = status;
+    return status;
+}
+
+int LinkQuality::controlIntervalMs() const {
+    return qCeil(1000.0 / m_controlRateHz);
+}
+
+int LinkQuality::sensorIntervalMs() const {
+    return qCeil(1000.0 / m_sensorRateHz);
+}
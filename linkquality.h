@@ -0,0 +1,86 @@
+#ifndef LINKQUALITY_H
+#define LINKQUALITY_H
+
+#include <QtGlobal>
+#include <QMetaType>
+
+/**
+ * 측정된 링크 품질(RTT, 송신 대기열 증가, 응답 손실)에 따라
+ * 제어 갱신 주기와 센서 폴링 주기를 AIMD 방식으로 조절하는 클래스입니다.
+ *
+ * 혼잡 신호가 없으면 전송률을 조금씩 올리고(가산 증가),
+ * 혼잡 신호가 보이면 전송률을 절반으로 줄입니다(승산 감소).
+ *
+ * 첫 유효 RTT 측정(시계 동기화 응답) 전에는 손실을 판단할 근거가 없으므로
+ * 전송률을 초기값으로 두고 조절하지 않습니다.
+ */
+
+enum class LinkHealth {
+    UNKNOWN, // 아직 측정값 없음 (AIMD 비활성)
+    GOOD,
+    DEGRADED,
+    BAD
+};
+
+// 한 평가 주기의 링크 상태 요약
+struct LinkStatus {
+    LinkHealth health = LinkHealth::UNKNOWN;
+    qint64 smoothedRttUs = 0;   // 평활화된 왕복 시간
+    double lossRate = 0.0;      // 평활화된 응답 손실률 (0~1)
+    qint64 writeBacklog = 0;    // 소켓 송신 대기 바이트 수
+    int controlIntervalMs = 0;  // 현재 제어 갱신 주기
+    int sensorIntervalMs = 0;   // 현재 센서 폴링 주기
+};
+
+class LinkQuality {
+public:
+    LinkQuality();
+
+    void reset();
+
+    // 측정값 입력
+    void addRoundTrip(qint64 rttUs);
+    void addProbeResult(bool answered);
+
+    // 주기적으로 호출하여 송신 대기열 크기를 반영하고 전송률을 조절합니다.
+    LinkStatus evaluate(qint64 writeBacklog);
+
+    int controlIntervalMs() const;
+    int sensorIntervalMs() const;
+    LinkStatus status() const { return m_status; }
+    bool isActive() const { return m_active; }
+
+    // 이보다 많은 바이트가 송신 대기 중이면 혼잡으로 판단합니다.
+    static constexpr qint64 backlogLimit() { return kBacklogLimit; }
+
+private:
+    static constexpr double kMinControlRateHz = 10.0;   // 100ms
+    static constexpr double kMaxControlRateHz = 200.0;  // 5ms
+    static constexpr double kInitialControlRateHz = 100.0;
+    static constexpr double kControlIncreaseHz = 10.0;
+    static constexpr double kMinSensorRateHz = 2.0;
+    static constexpr double kMaxSensorRateHz = 20.0;
+    static constexpr double kInitialSensorRateHz = 10.0;
+    static constexpr double kSensorIncreaseHz = 1.0;
+    static constexpr double kDecreaseFactor = 0.5;
+
+    static constexpr qint64 kBacklogLimit = 1024;        // 이보다 많이 쌓이면 혼잡으로 판단
+    static constexpr qint64 kQueueingDelayLimitUs = 20000; // 최소 RTT 대비 허용 큐잉 지연
+    static constexpr qint64 kBadRttUs = 200000;
+    static constexpr double kBadLossRate = 0.2;
+    static constexpr double kSmoothing = 0.125;          // RFC 6298 방식 평활 계수
+
+    bool m_active;               // 첫 유효 RTT 측정 이후에만 AIMD 동작
+    double m_controlRateHz;
+    double m_sensorRateHz;
+    qint64 m_minRttUs;
+    qint64 m_smoothedRttUs;
+    double m_lossRate;
+    qint64 m_previousBacklog;
+    bool m_lossSinceLastEvaluation;
+    LinkStatus m_status;
+};
+
+Q_DECLARE_METATYPE(LinkStatus) // 클라이언트 스레드에서 GUI로 시그널 전달
+
+#endif // LINKQUALITY_H
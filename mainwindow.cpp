@@ -14,17 +14,41 @@ MainWindow::MainWindow(QWidget *parent)
     , ui(new Ui::MainWindow) {
     ui->setupUi(this);
 
-    m_raspbotClient = new RaspbotClient(this);
+    // 장애물 정지 루프가 GUI 이벤트 처리에 막히지 않도록 클라이언트를 전용 스레드에서 실행합니다.
+    // (스레드를 옮기는 객체는 부모를 가질 수 없으므로 스레드 종료 시 삭제)
+    m_clientThread = new QThread(this);
+    m_raspbotClient = new RaspbotClient;
+    m_raspbotClient->moveToThread(m_clientThread);
+    connect(m_clientThread, &QThread::finished, m_raspbotClient, &QObject::deleteLater);
+    m_clientThread->start(QThread::HighPriority);
     currentMotorSpeed = 0; // 초기 속도
+    m_lastDistanceCm = -1;
+    m_lastDistanceTimeUs = 0;
 
     m_commandTimer = new QTimer(this);
-    connect(m_commandTimer, &QTimer::timeout, this, &MainWindow::processNextQueuedMotorCommand);
+    connect(m_commandTimer, &QTimer::timeout, this, &MainWindow::sendHeldDriveUpdate);
 
     // RaspbotClient의 시그널을 MainWindow의 슬롯에 연결
     connect(m_raspbotClient, &RaspbotClient::connected, this, &MainWindow::onClientConnected);
     connect(m_raspbotClient, &RaspbotClient::disconnected, this, &MainWindow::onClientDisconnected);
     connect(m_raspbotClient, &RaspbotClient::errorOccurred, this, &MainWindow::onClientError);
     connect(m_raspbotClient, &RaspbotClient::messageReceived, this, &MainWindow::onClientMessageReceived);
+    connect(m_raspbotClient, &RaspbotClient::latencyUpdated, this, &MainWindow::onClientLatencyUpdated);
+    connect(m_raspbotClient, &RaspbotClient::linkStatusUpdated, this, &MainWindow::onClientLinkStatusUpdated);
+    connect(m_raspbotClient, &RaspbotClient::obstacleStopped, this, &MainWindow::onClientObstacleStopped);
+    connect(m_raspbotClient, &RaspbotClient::obstacleCleared, this, &MainWindow::onClientObstacleCleared);
+
+    // 장애물 정지 거리 및 반응 한계 예산 설정
+    connect(ui->stopDistanceSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onStopDistanceChanged);
+    connect(ui->latencyBudgetSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::onLatencyBudgetChanged);
+
+    // 상태 표시줄에 상시 표시되는 장애물/링크 품질/지연 라벨
+    m_obstacleLabel = new QLabel(this);
+    ui->statusBar->addPermanentWidget(m_obstacleLabel);
+    m_linkLabel = new QLabel(this);
+    ui->statusBar->addPermanentWidget(m_linkLabel);
+    m_latencyLabel = new QLabel(this);
+    ui->statusBar->addPermanentWidget(m_latencyLabel);
 
     // 모터 제어 버튼 pressed/released 시그널 연결
     connect(ui->forwardButton, &QPushButton::pressed, this, &MainWindow::on_forwardButton_pressed);
@@ -46,10 +70,17 @@ MainWindow::MainWindow(QWidget *parent)
     ui->speedSlider->setMaximum(255);
     ui->speedSlider->setValue(100); // 초기 속도 100
     on_speedSlider_valueChanged(100); // 초기 속도 라벨 업데이트
+    ui->stopDistanceSpinBox->setValue(20); // 초기 장애물 정지 거리 20cm
+    onStopDistanceChanged(ui->stopDistanceSpinBox->value());
+    ui->latencyBudgetSpinBox->setValue(100); // 초기 장애물 반응 한계 예산 100ms
+    onLatencyBudgetChanged(ui->latencyBudgetSpinBox->value());
     updateConnectionStatus(false);
 }
 
 MainWindow::~MainWindow() {
+    // 클라이언트는 스레드 종료(finished) 시 해당 스레드에서 삭제됩니다.
+    m_clientThread->quit();
+    m_clientThread->wait();
     delete ui;
 }
 
@@ -71,10 +102,19 @@ void MainWindow::on_disconnectButton_clicked() {
 void MainWindow::onClientConnected() {
     updateConnectionStatus(true);
     ui->statusBar->showMessage(tr("서버에 연결되었습니다."), 3000);
+
+    // 장애물 정지 루프를 위해 초음파 센서를 켜고 센서 폴링 시작
+    m_raspbotClient->controlUltrasonic(DeviceStatus::ON);
+    m_raspbotClient->setSensorPollingEnabled(true);
 }
 
 void MainWindow::onClientDisconnected() {
     updateConnectionStatus(false);
+    m_latencyLabel->clear();
+    m_linkLabel->clear();
+    m_obstacleLabel->clear();
+    m_lastDistanceCm = -1;
+    m_lastDistanceTimeUs = 0;
     ui->statusBar->showMessage(tr("서버와 연결이 끊겼습니다."), 3000);
 }
 
@@ -85,81 +125,168 @@ void MainWindow::onClientError(QTcpSocket::SocketError socketError) {
     QMessageBox::critical(this, tr("연결 오류"), tr("소켓 오류 발생: %1").arg(m_raspbotClient->errorString()));
 }
 
-void MainWindow::onClientMessageReceived(const QString &message) {
-    ui->logTextEdit->append(tr("서버 응답: %1").arg(message));
-
+bool MainWindow::parseServerReply(const QString &message, QJsonObject &reply) {
     QJsonParseError jsonError;
     QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8(), &jsonError);
+    if (jsonError.error != QJsonParseError::NoError || !doc.isObject()) {
+        return false;
+    }
+    reply = doc.object();
+    return true;
+}
 
-    if (jsonError.error == QJsonParseError::NoError && doc.isObject()) {
-        QJsonObject obj = doc.object();
-        if (obj.contains("command") && obj.value("command").toString() == "READ_ULTRASONIC" && obj.contains("distance")) {
-            int distance = obj.value("distance").toInt();
-            ui->logTextEdit->append(tr("-> 초음파 거리: %1 cm").arg(distance));
+void MainWindow::onClientMessageReceived(const QString &message, qint64 clientTimestampUs) {
+    // clientTimestampUs: 서버 타임스탬프를 클라이언트 시계로 보정한 측정 시각 (없으면 수신 시각)
+    QJsonObject obj;
+    if (parseServerReply(message, obj)) {
+        QString command = obj.value("command").toString();
+
+        // 주기적으로 폴링되는 센서 응답은 로그에 남기지 않고 상태 표시줄만 갱신합니다.
+        if (command == "READ_ULTRASONIC" && obj.contains("distance")) {
+            m_lastDistanceCm = obj.value("distance").toInt();
+            m_lastDistanceTimeUs = clientTimestampUs;
+            // 측정부터 화면 표시까지 걸린 시간을 함께 표시
+            m_obstacleLabel->setText(tr("거리 %1 cm (%2 ms 전)")
+                                         .arg(m_lastDistanceCm)
+                                         .arg((m_raspbotClient->clientTimeUs() - clientTimestampUs) / 1000.0, 0, 'f', 0));
+            return;
+        }
+        if (command == "READ_IR_SENSOR") {
+            return;
         }
         // 다른 센서 응답 처리
     }
+
+    ui->logTextEdit->append(tr("[%1 s] 서버 응답: %2").arg(clientTimestampUs / 1000000.0, 0, 'f', 3).arg(message));
 }
 
-// --- 모터 제어 슬롯 구현 ---
+void MainWindow::onClientObstacleStopped(int distanceCm, qint64 stopLatencyUs, qint64 reactionBoundUs, bool withinBudget, bool staleSample) {
+    // 정지 명령은 이미 전송되었으므로 주행 갱신 스트림만 멈춥니다 (버튼을 다시 눌러야 재개).
+    m_heldDriveUpdate = nullptr;
+    m_commandTimer->stop();
 
-void MainWindow::stopAllMotors() {
-    if (!m_raspbotClient->isConnected()) return;
+    if (staleSample) {
+        // 링크가 지연 예산 안에 센서 값을 전달하지 못하는 동안에는 전진이 막힙니다.
+        ui->logTextEdit->append(tr("링크 지연 정지: 센서 값이 지연 예산 안에 도착하지 않음, 샘플→정지 %1 ms")
+                                    .arg(stopLatencyUs / 1000.0, 0, 'f', 1));
+        ui->statusBar->showMessage(tr("링크 지연 - 전진이 차단되었습니다."), 3000);
+        return;
+    }
 
-    // 모터 명령 큐 비우고 타이머 중지
-    m_motorCommandQueue.clear();
+    ui->logTextEdit->append(tr("장애물 정지: 거리 %1 cm, 센서→정지 지연 %2 ms, 반응 한계 %3 ms%4")
+                                .arg(distanceCm)
+                                .arg(stopLatencyUs / 1000.0, 0, 'f', 1)
+                                .arg(reactionBoundUs / 1000.0, 0, 'f', 1)
+                                .arg(withinBudget ? QString() : tr(" (지연 예산 초과)")));
+    ui->statusBar->showMessage(tr("장애물 감지 - 전진이 차단되었습니다."), 3000);
+}
 
+void MainWindow::onClientObstacleCleared() {
+    ui->statusBar->showMessage(tr("장애물 해제 - 전진이 가능합니다."), 3000);
+}
 
-    // 모든 모터를 속도 0으로 설정하여 정지
-    m_raspbotClient->controlMotor(MotorNumber::L1, MotorDirection::FORWARD, 0);
-    m_raspbotClient->controlMotor(MotorNumber::L2, MotorDirection::FORWARD, 0);
-    m_raspbotClient->controlMotor(MotorNumber::R1, MotorDirection::FORWARD, 0);
-    m_raspbotClient->controlMotor(MotorNumber::R2, MotorDirection::FORWARD, 0);
+void MainWindow::onStopDistanceChanged(int distanceCm) {
+    m_raspbotClient->setObstacleStopDistance(distanceCm);
+}
 
-    if (!m_commandTimer->isActive()) {
-        m_commandTimer->start(10); // 10ms 딜레이 후 다음 명령 실행
-        processNextQueuedMotorCommand(); // 첫 번째 명령 즉시 실행
+void MainWindow::onLatencyBudgetChanged(int budgetMs) {
+    // 예산이 짧을수록 센서 폴링 최소 주기도 함께 짧아집니다.
+    m_raspbotClient->setObstacleLatencyBudget(budgetMs);
+}
+
+void MainWindow::onClientLatencyUpdated(const LinkLatency &latency) {
+    // 업링크(Wi-Fi 송신), 다운링크(Wi-Fi 수신), 서버 처리(Pi) 시간을 나누어 표시
+    // 업링크/다운링크는 최소 지연 샘플을 대칭으로 가정한 추정치입니다 (clocksync.h 참고).
+    m_latencyLabel->setText(tr("추정 ↑ %1 ms  ↓ %2 ms  처리 %3 ms  오프셋 %4 ms  드리프트 %5 ppm")
+                                .arg(latency.uplinkUs / 1000.0, 0, 'f', 1)
+                                .arg(latency.downlinkUs / 1000.0, 0, 'f', 1)
+                                .arg(latency.serverProcessingUs / 1000.0, 0, 'f', 1)
+                                .arg(latency.offsetUs / 1000.0, 0, 'f', 1)
+                                .arg(latency.driftPpm, 0, 'f', 1));
+}
+
+void MainWindow::onClientLinkStatusUpdated(const LinkStatus &status) {
+    // 측정된 링크 품질에 맞춰 제어 갱신(네 모터 묶음) 사이의 주기 조절
+    if (m_commandTimer->interval() != status.controlIntervalMs) {
+        m_commandTimer->setInterval(status.controlIntervalMs);
+    }
+
+    QString health;
+    switch (status.health) {
+    case LinkHealth::UNKNOWN:
+        health = tr("측정 전");
+        break;
+    case LinkHealth::GOOD:
+        health = tr("양호");
+        break;
+    case LinkHealth::DEGRADED:
+        health = tr("혼잡");
+        break;
+    case LinkHealth::BAD:
+        health = tr("불량");
+        break;
     }
+    m_linkLabel->setText(tr("링크 %1  RTT %2 ms  손실 %3%  대기 %4 B  제어 %5 ms  센서 %6 ms")
+                             .arg(health)
+                             .arg(status.smoothedRttUs / 1000.0, 0, 'f', 1)
+                             .arg(status.lossRate * 100.0, 0, 'f', 0)
+                             .arg(status.writeBacklog)
+                             .arg(status.controlIntervalMs)
+                             .arg(status.sensorIntervalMs));
+}
+
+// --- 모터 제어 슬롯 구현 ---
 
+void MainWindow::stopAllMotors() {
+    if (!m_raspbotClient->isConnected()) return;
+
+    // 주행 갱신 스트림 중지
+    m_heldDriveUpdate = nullptr;
     m_commandTimer->stop();
+
+    // 정지 명령은 주기 조절이나 송신 대기열 상태와 무관하게 즉시 전송
+    m_raspbotClient->driveMotors(MotorDirection::FORWARD, MotorDirection::FORWARD, 0);
+
     qDebug() << "모터 정지";
 }
 
-void MainWindow::processNextQueuedMotorCommand() {
-    if (m_motorCommandQueue.isEmpty()) {
+void MainWindow::startDriveStream(std::function<void()> update) {
+    // 버튼을 누르고 있는 동안 같은 제어 갱신을 링크 품질에 맞춘 주기로 반복 전송합니다.
+    // (좋은 링크에서는 갱신 주기가 짧아져 속도 변경 등이 더 빨리 반영됨)
+    m_heldDriveUpdate = update;
+    m_commandTimer->start(m_raspbotClient->controlIntervalMs());
+    sendHeldDriveUpdate(); // 첫 갱신 즉시 전송
+}
+
+void MainWindow::sendHeldDriveUpdate() {
+    if (!m_heldDriveUpdate) {
         m_commandTimer->stop();
         return;
     }
 
-    std::function<void()> cmd = m_motorCommandQueue.takeFirst();
-    cmd(); // 저장된 명령 실행
+    // 송신 대기열이 밀려 있으면 지연만 늘어나므로 이번 주기는 건너뜁니다.
+    if (m_raspbotClient->isWriteCongested()) {
+        return;
+    }
+
+    m_heldDriveUpdate(); // 현재 제어 갱신(네 모터 명령) 전송
 }
 
 void MainWindow::on_forwardButton_pressed() {
     if (!m_raspbotClient->isConnected()) return;
-    qDebug() << "앞으로 이동 - 속도:" << currentMotorSpeed;
-
-    m_motorCommandQueue.clear(); // 기존 명령 큐 비우기
+    // 세대를 정지 상태보다 먼저 읽습니다. 그 사이 장애물 정지가 일어나면 정지 상태를 보거나,
+    // 이 세대로 만든 갱신이 클라이언트에서 버려집니다.
+    int epoch = m_raspbotClient->driveEpoch();
+    // 장애물 정지 상태에서는 전진하지 않습니다 (후진/회전으로 빠져나올 수 있음).
+    if (m_raspbotClient->isObstacleStopActive()) {
+        ui->statusBar->showMessage(tr("장애물 감지 - 전진이 차단되었습니다."), 3000);
+        return;
+    }
+    qDebug() << "앞으로 이동 갱신 시작 - 속도:" << currentMotorSpeed;
 
-    // 각 모터 제어 명령을 람다 함수로 큐에 추가
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::L1, MotorDirection::FORWARD, currentMotorSpeed);
-    });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::L2, MotorDirection::FORWARD, currentMotorSpeed);
-    });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::R1, MotorDirection::FORWARD, currentMotorSpeed);
+    startDriveStream([this, epoch]() {
+        m_raspbotClient->driveMotors(MotorDirection::FORWARD, MotorDirection::FORWARD, currentMotorSpeed, epoch);
     });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::R2, MotorDirection::FORWARD, currentMotorSpeed);
-    });
-
-    // 타이머가 동작 중이 아니면 시작
-    if (!m_commandTimer->isActive()) {
-        m_commandTimer->start(10); // 10ms 딜레이 후 다음 명령 실행 (적절한 값으로 조절)
-        processNextQueuedMotorCommand(); // 첫 번째 명령 즉시 실행
-    }
 
     // m_raspbotClient->controlMotor(MotorNumber::L1, MotorDirection::FORWARD, currentMotorSpeed);
     // m_raspbotClient->controlMotor(MotorNumber::L2, MotorDirection::FORWARD, currentMotorSpeed);
@@ -173,29 +300,14 @@ void MainWindow::on_forwardButton_released() {
 
 void MainWindow::on_backwardButton_pressed() {
     if (!m_raspbotClient->isConnected()) return;
+    int epoch = m_raspbotClient->driveEpoch();
 
-    qDebug() << "뒤로 이동 명령 큐에 추가 - 속도:" << currentMotorSpeed;
-
-    m_motorCommandQueue.clear();
+    qDebug() << "뒤로 이동 갱신 시작 - 속도:" << currentMotorSpeed;
 
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::L1, MotorDirection::BACKWARD, currentMotorSpeed);
-    });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::L2, MotorDirection::BACKWARD, currentMotorSpeed);
-    });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::R1, MotorDirection::BACKWARD, currentMotorSpeed);
-    });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::R2, MotorDirection::BACKWARD, currentMotorSpeed);
+    startDriveStream([this, epoch]() {
+        m_raspbotClient->driveMotors(MotorDirection::BACKWARD, MotorDirection::BACKWARD, currentMotorSpeed, epoch);
     });
 
-    if (!m_commandTimer->isActive()) {
-        m_commandTimer->start(10);
-        processNextQueuedMotorCommand();
-    }
-
     // qDebug() << "뒤로 이동 - 속도:" << currentMotorSpeed;
     // m_raspbotClient->controlMotor(MotorNumber::L1, MotorDirection::BACKWARD, currentMotorSpeed);
     // m_raspbotClient->controlMotor(MotorNumber::L2, MotorDirection::BACKWARD, currentMotorSpeed);
@@ -209,28 +321,13 @@ void MainWindow::on_backwardButton_released() {
 
 void MainWindow::on_leftButton_pressed() {
     if (!m_raspbotClient->isConnected()) return;
+    int epoch = m_raspbotClient->driveEpoch();
 
-    qDebug() << "좌회전 명령 큐에 추가 - 속도:" << currentMotorSpeed;
-
-    m_motorCommandQueue.clear();
+    qDebug() << "좌회전 갱신 시작 - 속도:" << currentMotorSpeed;
 
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::L1, MotorDirection::BACKWARD, currentMotorSpeed);
-    });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::L2, MotorDirection::BACKWARD, currentMotorSpeed);
-    });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::R1, MotorDirection::FORWARD, currentMotorSpeed);
+    startDriveStream([this, epoch]() {
+        m_raspbotClient->driveMotors(MotorDirection::BACKWARD, MotorDirection::FORWARD, currentMotorSpeed, epoch);
     });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::R2, MotorDirection::FORWARD, currentMotorSpeed);
-    });
-
-    if (!m_commandTimer->isActive()) {
-        m_commandTimer->start(10);
-        processNextQueuedMotorCommand();
-    }
 
     // qDebug() << "좌회전 - 속도:" << currentMotorSpeed;
     // // 제자리 좌회전: 왼쪽 모터 뒤로, 오른쪽 모터 앞으로
@@ -246,29 +343,14 @@ void MainWindow::on_leftButton_released() {
 
 void MainWindow::on_rightButton_pressed() {
     if (!m_raspbotClient->isConnected()) return;
+    int epoch = m_raspbotClient->driveEpoch();
 
-    qDebug() << "우회전 명령 큐에 추가 - 속도:" << currentMotorSpeed;
-
-    m_motorCommandQueue.clear();
+    qDebug() << "우회전 갱신 시작 - 속도:" << currentMotorSpeed;
 
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::L1, MotorDirection::FORWARD, currentMotorSpeed);
-    });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::L2, MotorDirection::FORWARD, currentMotorSpeed);
-    });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::R1, MotorDirection::BACKWARD, currentMotorSpeed);
-    });
-    m_motorCommandQueue.append([this]() {
-        m_raspbotClient->controlMotor(MotorNumber::R2, MotorDirection::BACKWARD, currentMotorSpeed);
+    startDriveStream([this, epoch]() {
+        m_raspbotClient->driveMotors(MotorDirection::FORWARD, MotorDirection::BACKWARD, currentMotorSpeed, epoch);
     });
 
-    if (!m_commandTimer->isActive()) {
-        m_commandTimer->start(10);
-        processNextQueuedMotorCommand();
-    }
-
     // qDebug() << "우회전 - 속도:" << currentMotorSpeed;
     // // 제자리 우회전: 왼쪽 모터 앞으로, 오른쪽 모터 뒤로
     // m_raspbotClient->controlMotor(MotorNumber::L1, MotorDirection::FORWARD, currentMotorSpeed);
@@ -297,7 +379,15 @@ void MainWindow::on_buzzerOnBtn_clicked() {
 }
 
 void MainWindow::on_requestUltrasonicBtn_clicked() {
-    m_raspbotClient->requestUltrasonicDistance();
+    // 초음파 센서는 장애물 정지 루프가 계속 폴링하므로 응답을 구분할 수 없는
+    // 추가 요청을 보내지 않고 가장 최근에 받은 거리를 기록합니다.
+    if (m_lastDistanceCm < 0) {
+        ui->logTextEdit->append(tr("아직 수신된 초음파 거리가 없습니다."));
+        return;
+    }
+    ui->logTextEdit->append(tr("-> 초음파 거리: %1 cm (%2 ms 전 측정)")
+                                .arg(m_lastDistanceCm)
+                                .arg((m_raspbotClient->clientTimeUs() - m_lastDistanceTimeUs) / 1000.0, 0, 'f', 0));
 }
 
 void MainWindow::updateConnectionStatus(bool connected) {
@@ -2,6 +2,10 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QLabel>
+#include <QThread>
+#include <functional>
+#include <QJsonObject>
 #include "raspbotclient.h"
 
 QT_BEGIN_NAMESPACE
@@ -41,17 +45,34 @@ private slots:
     void onClientConnected();
     void onClientDisconnected();
     void onClientError(QTcpSocket::SocketError socketError);
-    void onClientMessageReceived(const QString &message);
+    void onClientMessageReceived(const QString &message, qint64 clientTimestampUs);
+    void onClientLatencyUpdated(const LinkLatency &latency);
+    void onClientLinkStatusUpdated(const LinkStatus &status);
+    void onClientObstacleStopped(int distanceCm, qint64 stopLatencyUs, qint64 reactionBoundUs, bool withinBudget, bool staleSample);
+    void onClientObstacleCleared();
+    void onStopDistanceChanged(int distanceCm);
+    void onLatencyBudgetChanged(int budgetMs);
 
 private:
+    friend class RaspbotBenchmark;
+
     Ui::MainWindow *ui;
     RaspbotClient *m_raspbotClient;
+    QThread *m_clientThread; // 소켓 통신과 장애물 정지 루프를 실행하는 스레드
     void updateConnectionStatus(bool connected); // 연결 상태에 따라 UI 활성화/비활성화
+    static bool parseServerReply(const QString &message, QJsonObject &reply); // 서버 응답 JSON 객체 파싱
     void stopAllMotors(); // 모든 모터를 정지시키는 헬퍼 함수
     unsigned char currentMotorSpeed; // 현재 설정된 모터 속도
 
-    QList<std::function<void()>> m_motorCommandQueue; // 실행할 모터 명령 큐
-    QTimer *m_commandTimer; // 명령 실행 간 딜레이를 위한 타이머
-    void processNextQueuedMotorCommand(); // 큐에서 다음 명령 처리 함수
+    std::function<void()> m_heldDriveUpdate; // 버튼을 누르고 있는 동안 반복 전송할 제어 갱신 (네 모터 명령)
+    QTimer *m_commandTimer; // 제어 갱신 반복 주기 타이머 (링크 품질에 따라 조절)
+    void sendHeldDriveUpdate(); // 타이머 틱마다 현재 제어 갱신 전송
+    void startDriveStream(std::function<void()> update); // 링크 품질에 맞춘 주기로 제어 갱신 반복 시작
+
+    QLabel *m_latencyLabel; // 상태 표시줄의 구간별 지연 표시
+    QLabel *m_linkLabel;    // 상태 표시줄의 링크 품질 표시
+    QLabel *m_obstacleLabel; // 상태 표시줄의 최근 초음파 거리 표시
+    int m_lastDistanceCm; // 최근 수신한 초음파 거리 (없으면 -1)
+    qint64 m_lastDistanceTimeUs; // 그 거리의 측정 시각 (클라이언트 시계)
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,82 @@
+#include "obstacleguard.h"
+
+ObstacleGuard::ObstacleGuard()
+    : m_stopDistanceCm(kDefaultStopDistanceCm), m_latencyBudgetUs(kDefaultLatencyBudgetUs),
+      m_pollIntervalUs(0) {
+    reset();
+}
+
+void ObstacleGuard::reset() {
+    m_tripped = false;
+    m_tripStale = false;
+    m_ultrasonicClear = true;
+    m_infraredClear = true;
+    m_lastDistanceCm = -1;
+    m_lastSampleTimeUs = 0;
+    m_tripSampleTimeUs = 0;
+    m_lastStopLatencyUs = 0;
+    m_maxStopLatencyUs = 0;
+    m_budgetViolations = 0;
+}
+
+ObstacleAction ObstacleGuard::onUltrasonicSample(int distanceCm, qint64 sampleTimeUs, qint64 nowUs) {
+    m_lastDistanceCm = distanceCm;
+    // 0 이하는 측정 실패 값이므로 장애물 판단에 쓰지 않습니다.
+    bool valid = distanceCm > 0;
+    bool obstacle = valid && distanceCm < m_stopDistanceCm;
+    m_ultrasonicClear = valid && distanceCm > m_stopDistanceCm + kReleaseHysteresisCm;
+    return evaluate(obstacle, m_ultrasonicClear && m_infraredClear, sampleTimeUs, nowUs);
+}
+
+ObstacleAction ObstacleGuard::onInfraredSample(bool obstacle, qint64 sampleTimeUs, qint64 nowUs) {
+    m_infraredClear = !obstacle;
+    return evaluate(obstacle, m_ultrasonicClear && m_infraredClear, sampleTimeUs, nowUs);
+}
+
+ObstacleAction ObstacleGuard::onPollTick(qint64 nowUs) {
+    // 샘플을 한 번도 받지 못했으면 센서 미지원일 수 있으므로 판단하지 않습니다.
+    if (m_tripped || m_lastSampleTimeUs == 0) {
+        return ObstacleAction::NONE;
+    }
+    if (nowUs - m_lastSampleTimeUs > m_latencyBudgetUs) {
+        m_tripped = true;
+        m_tripStale = true;
+        m_tripSampleTimeUs = m_lastSampleTimeUs;
+        return ObstacleAction::STOP;
+    }
+    return ObstacleAction::NONE;
+}
+
+ObstacleAction ObstacleGuard::evaluate(bool obstacle, bool clear, qint64 sampleTimeUs, qint64 nowUs) {
+    bool stale = (nowUs - sampleTimeUs) + m_pollIntervalUs > m_latencyBudgetUs;
+    m_lastSampleTimeUs = qMax(m_lastSampleTimeUs, sampleTimeUs);
+
+    if (!m_tripped) {
+        if (obstacle || stale) {
+            m_tripped = true;
+            m_tripStale = !obstacle;
+            m_tripSampleTimeUs = sampleTimeUs;
+            return ObstacleAction::STOP;
+        }
+        return ObstacleAction::NONE;
+    }
+
+    // 해제는 예산 안에 도착한 새 샘플로만 판단합니다.
+    if (clear && !stale) {
+        m_tripped = false;
+        return ObstacleAction::RELEASE;
+    }
+    return ObstacleAction::NONE;
+}
+
+bool ObstacleGuard::recordStopSent(qint64 wireTimeUs) {
+    m_lastStopLatencyUs = wireTimeUs - m_tripSampleTimeUs;
+    if (m_lastStopLatencyUs > m_maxStopLatencyUs) {
+        m_maxStopLatencyUs = m_lastStopLatencyUs;
+    }
+    if (lastReactionBoundUs() > m_latencyBudgetUs) {
+        ++m_budgetViolations;
+        return false;
+    }
+    return true;
+}
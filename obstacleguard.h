@@ -0,0 +1,82 @@
+#ifndef OBSTACLEGUARD_H
+#define OBSTACLEGUARD_H
+
+#include <QtGlobal>
+
+/**
+ * 스트리밍되는 초음파/적외선 센서 값을 보고 장애물 정지 여부를 판단하는 클래스입니다.
+ *
+ * 설정 거리보다 가까운 초음파 값이나 적외선 장애물 감지가 들어오면 정지 상태가 되고,
+ * 해제 거리(정지 거리 + 히스테리시스) 밖의 새 값이 들어와야 해제됩니다.
+ * 실제 반응 한계는 (샘플 측정 → 정지 명령 송신 지연) + (센서 폴링 주기)입니다.
+ * 장애물은 두 샘플 사이 어느 시점에든 나타날 수 있기 때문입니다. 지연 예산은 이
+ * 반응 한계에 적용되며, 폴링 주기는 예산의 절반을 넘지 않아야 합니다.
+ * 도착 시점의 샘플 나이와 폴링 주기의 합이 이미 예산을 넘는 샘플은 로봇 위치를
+ * 보장할 수 없으므로 장애물로 간주합니다(fail-safe). 응답 손실이나 폴링 생략으로
+ * 예산 동안 새 샘플이 하나도 없을 때도 같은 이유로 정지합니다.
+ *
+ * 모든 시각은 클라이언트 시계 기준 마이크로초입니다.
+ */
+
+enum class ObstacleAction {
+    NONE,
+    STOP,    // 즉시 정지 명령을 보내야 함
+    RELEASE  // 정지 상태 해제
+};
+
+class ObstacleGuard {
+public:
+    ObstacleGuard();
+
+    void reset();
+
+    void setStopDistanceCm(int distanceCm) { m_stopDistanceCm = distanceCm; }
+    int stopDistanceCm() const { return m_stopDistanceCm; }
+    void setLatencyBudgetUs(qint64 budgetUs) { m_latencyBudgetUs = budgetUs; }
+    qint64 latencyBudgetUs() const { return m_latencyBudgetUs; }
+    // 예산을 지키기 위한 최대 센서 폴링 주기 (링크 품질과 무관한 하한 전송률)
+    qint64 maxPollIntervalUs() const { return m_latencyBudgetUs / 2; }
+    void setPollIntervalUs(qint64 intervalUs) { m_pollIntervalUs = intervalUs; }
+    qint64 pollIntervalUs() const { return m_pollIntervalUs; }
+
+    // 센서 샘플 평가 (sampleTimeUs: 센서 측정 시각, nowUs: 수신 처리 시각)
+    ObstacleAction onUltrasonicSample(int distanceCm, qint64 sampleTimeUs, qint64 nowUs);
+    ObstacleAction onInfraredSample(bool obstacle, qint64 sampleTimeUs, qint64 nowUs);
+    // 폴링 주기마다 호출하여 마지막 샘플 이후 예산이 지났는지 확인합니다.
+    ObstacleAction onPollTick(qint64 nowUs);
+
+    // 정지 명령이 소켓에 기록된 시각을 기록합니다. 반응 한계가 예산 안이면 true를 반환합니다.
+    bool recordStopSent(qint64 wireTimeUs);
+
+    bool isTripped() const { return m_tripped; }
+    bool isTripStale() const { return m_tripStale; } // 장애물이 아니라 샘플 지연/부재로 정지했는지
+    int lastDistanceCm() const { return m_lastDistanceCm; }
+    qint64 lastStopLatencyUs() const { return m_lastStopLatencyUs; }
+    qint64 maxStopLatencyUs() const { return m_maxStopLatencyUs; }
+    qint64 lastReactionBoundUs() const { return m_lastStopLatencyUs + m_pollIntervalUs; }
+    int budgetViolations() const { return m_budgetViolations; }
+
+private:
+    ObstacleAction evaluate(bool obstacle, bool clear, qint64 sampleTimeUs, qint64 nowUs);
+
+    static constexpr int kDefaultStopDistanceCm = 20;
+    static constexpr int kReleaseHysteresisCm = 5;
+    static constexpr qint64 kDefaultLatencyBudgetUs = 100 * 1000;
+
+    int m_stopDistanceCm;
+    qint64 m_latencyBudgetUs;
+    qint64 m_pollIntervalUs;    // 현재 센서 폴링 주기
+
+    bool m_tripped;
+    bool m_tripStale;
+    bool m_ultrasonicClear;     // 마지막 초음파 값이 해제 거리 밖인지
+    bool m_infraredClear;       // 마지막 적외선 값이 장애물 없음인지
+    int m_lastDistanceCm;
+    qint64 m_lastSampleTimeUs;  // 가장 최근 샘플의 측정 시각 (0이면 아직 없음)
+    qint64 m_tripSampleTimeUs;  // 정지를 유발한 샘플의 측정 시각
+    qint64 m_lastStopLatencyUs; // 샘플 측정부터 정지 명령 송신까지
+    qint64 m_maxStopLatencyUs;
+    int m_budgetViolations;
+};
+
+#endif // OBSTACLEGUARD_H
@@ -1,21 +1,66 @@
 #include "raspbotclient.h"
 #include <QDebug>
 #include <QHostAddress>
+#include <QJsonParseError>
+#include <QMetaObject>
+#include <QThread>
+#include <QVector>
+
+namespace {
+// 시계 동기화 요청 주기: 샘플 창이 찰 때까지는 빠르게, 이후에는 느리게 보냅니다.
+constexpr int kSyncFastIntervalMs = 200;
+constexpr int kSyncIntervalMs = 1000;
+constexpr int kSyncFastSampleCount = 8;
+constexpr int kSyncMaxBackoff = 5; // 응답이 없을 때 주기를 최대 2^5배까지 늘림
+
+constexpr int kLinkEvaluationIntervalMs = 250; // 링크 품질 평가 주기
+constexpr qint64 kProbeTimeoutUs = 1000 * 1000; // 이 시간 안에 응답이 없으면 손실로 간주
+}
 
 RaspbotClient::RaspbotClient(QObject *parent)
-    : QObject(parent), m_socket(new QTcpSocket(this)) {
+    : QObject(parent), m_socket(new QTcpSocket(this)), m_syncTimer(new QTimer(this)),
+      m_syncAwaitingReply(false), m_syncBackoff(0),
+      m_linkTimer(new QTimer(this)), m_sensorPollTimer(new QTimer(this)),
+      m_connected(false), m_writeBacklog(0), m_controlIntervalMs(m_linkQuality.controlIntervalMs()),
+      m_obstacleStopActive(false), m_driveEpoch(0) {
+    // 스레드 간 시그널로 전달되는 타입 등록
+    qRegisterMetaType<QTcpSocket::SocketError>("QTcpSocket::SocketError");
+    qRegisterMetaType<LinkLatency>("LinkLatency");
+    qRegisterMetaType<LinkStatus>("LinkStatus");
+
+    m_clock.start();
+    connect(m_syncTimer, &QTimer::timeout, this, &RaspbotClient::sendTimeSyncRequest);
+    connect(m_linkTimer, &QTimer::timeout, this, &RaspbotClient::evaluateLinkQuality);
+    connect(m_sensorPollTimer, &QTimer::timeout, this, &RaspbotClient::pollSensors);
     connect(m_socket, &QTcpSocket::connected, this, &RaspbotClient::onConnected);
     connect(m_socket, &QTcpSocket::disconnected, this, &RaspbotClient::onDisconnected);
     connect(m_socket, &QTcpSocket::readyRead, this, &RaspbotClient::onReadyRead);
+    connect(m_socket, &QTcpSocket::bytesWritten, this, &RaspbotClient::onBytesWritten);
     connect(m_socket, QOverload<QTcpSocket::SocketError>::of(&QTcpSocket::errorOccurred),
             this, &RaspbotClient::onErrorOccurred);
 }
 
 RaspbotClient::~RaspbotClient() {
-    disconnectFromServer();
+    // 소멸 중에는 다른 스레드로 넘기지 않고 소켓을 바로 닫습니다.
+    if (m_socket->state() == QTcpSocket::ConnectedState) {
+        m_socket->disconnectFromHost();
+    }
+}
+
+bool RaspbotClient::isClientThread() const {
+    return QThread::currentThread() == thread();
+}
+
+QString RaspbotClient::errorString() const {
+    QMutexLocker locker(&m_errorMutex);
+    return m_errorString;
 }
 
 bool RaspbotClient::connectToServer(const QString &host, int port) {
+    if (!isClientThread()) {
+        QMetaObject::invokeMethod(this, [this, host, port]() { connectToServer(host, port); }, Qt::QueuedConnection);
+        return true; // 연결 시도는 클라이언트 스레드에서 진행
+    }
     if (m_socket->state() == QTcpSocket::ConnectedState) {
         qDebug() << "이미 서버에 연결되어 있습니다.";
         return true;
@@ -30,17 +75,22 @@ bool RaspbotClient::connectToServer(const QString &host, int port) {
 }
 
 void RaspbotClient::disconnectFromServer() {
+    if (!isClientThread()) {
+        QMetaObject::invokeMethod(this, [this]() { disconnectFromServer(); }, Qt::QueuedConnection);
+        return;
+    }
     if (m_socket->state() == QTcpSocket::ConnectedState) {
         m_socket->disconnectFromHost();
         qDebug() << "서버에서 연결 해제 요청.";
     }
 }
 
-bool RaspbotClient::isConnected() const {
-    return m_socket->state() == QTcpSocket::ConnectedState;
-}
-
 bool RaspbotClient::sendCommand(const QString &command) {
+    if (!isClientThread()) {
+        QMetaObject::invokeMethod(this, [this, command]() { sendCommand(command); }, Qt::QueuedConnection);
+        return isConnected();
+    }
+
     if (!isConnected()) {
         qWarning() << "서버에 연결되어 있지 않습니다. 명령을 보낼 수 없습니다.";
         return false;
@@ -58,16 +108,52 @@ bool RaspbotClient::sendCommand(const QString &command) {
         return false;
     }
     m_socket->flush(); // 버퍼 비우기
-    qDebug() << "명령 전송:" << command;
+    updateWriteBacklog();
+    // 이 스레드는 장애물 정지 경로를 담당하므로 폴링/동기화 요청마다 콘솔 로그를 쓰지 않습니다.
     return true;
 }
 
 // 직접 제어 메소드 구현 (RESTful API 엔드포인트 사용)
-bool RaspbotClient::controlMotor(MotorNumber motor, MotorDirection direction, int speed) {
+bool RaspbotClient::controlMotor(MotorNumber motor, MotorDirection direction, int speed, int driveEpoch) {
+    if (driveEpoch < 0) {
+        driveEpoch = m_driveEpoch.load();
+    }
+    if (!isClientThread()) {
+        QMetaObject::invokeMethod(this, [=]() { controlMotor(motor, direction, speed, driveEpoch); }, Qt::QueuedConnection);
+        return isConnected();
+    }
+    // 장애물 정지 이전에 만들어진 주행 명령은 정지 뒤에 도착해도 보내지 않습니다.
+    if (speed > 0 && driveEpoch != m_driveEpoch.load()) {
+        return false;
+    }
     QString cmd = CommandBuilder::buildMotorCommand(motor, direction, speed);
     return sendCommand(cmd);
 }
 
+bool RaspbotClient::driveMotors(MotorDirection left, MotorDirection right, int speed, int driveEpoch) {
+    if (driveEpoch < 0) {
+        driveEpoch = m_driveEpoch.load();
+    }
+    if (!isClientThread()) {
+        QMetaObject::invokeMethod(this, [=]() { driveMotors(left, right, speed, driveEpoch); }, Qt::QueuedConnection);
+        return isConnected();
+    }
+    if (speed > 0) {
+        // 전진 차단은 GUI 쪽 상태가 아니라 이 스레드의 장애물 판단기로 결정합니다.
+        if (left == MotorDirection::FORWARD && right == MotorDirection::FORWARD && m_obstacleGuard.isTripped()) {
+            return false;
+        }
+        if (driveEpoch != m_driveEpoch.load()) {
+            return false;
+        }
+    }
+    if (!writeMotorUpdate(left, right, speed)) {
+        qWarning() << "모터 명령 쓰기 오류:" << m_socket->errorString();
+        return false;
+    }
+    return true;
+}
+
 bool RaspbotClient::controlServo(int servoNumber, int angle) {
     QString cmd = CommandBuilder::buildServoCommand(servoNumber, angle);
     return sendCommand(cmd);
@@ -118,32 +204,317 @@ void RaspbotClient::requestInfraredCodeValue() {
     sendCommand(cmd);
 }
 
+qint64 RaspbotClient::toClientTime(qint64 serverTimeUs) const {
+    return m_clockSync.toClientTime(serverTimeUs);
+}
+
+void RaspbotClient::setSensorPollingEnabled(bool enabled) {
+    if (!isClientThread()) {
+        QMetaObject::invokeMethod(this, [this, enabled]() { setSensorPollingEnabled(enabled); }, Qt::QueuedConnection);
+        return;
+    }
+    if (enabled) {
+        m_sensorPollTimer->start(sensorPollIntervalMs());
+    } else {
+        m_sensorPollTimer->stop();
+    }
+    updateSensorPollInterval();
+}
+
+void RaspbotClient::setObstacleStopDistance(int distanceCm) {
+    if (!isClientThread()) {
+        QMetaObject::invokeMethod(this, [this, distanceCm]() { setObstacleStopDistance(distanceCm); }, Qt::QueuedConnection);
+        return;
+    }
+    m_obstacleGuard.setStopDistanceCm(distanceCm);
+}
+
+void RaspbotClient::setObstacleLatencyBudget(int budgetMs) {
+    if (!isClientThread()) {
+        QMetaObject::invokeMethod(this, [this, budgetMs]() { setObstacleLatencyBudget(budgetMs); }, Qt::QueuedConnection);
+        return;
+    }
+    m_obstacleGuard.setLatencyBudgetUs(budgetMs * 1000LL);
+    updateSensorPollInterval();
+}
+
+int RaspbotClient::sensorPollIntervalMs() const {
+    int linkIntervalMs = m_linkQuality.sensorIntervalMs();
+    // 링크가 불량이면 예산이 요구하는 주기로 요청을 보내도 대기열에 쌓여 지연만 늘어나므로
+    // AIMD 주기를 그대로 따릅니다. 이때 폴링 주기가 예산의 절반을 넘으면 ObstacleGuard가
+    // 샘플을 오래된 값으로 판단해 정지하므로, 예산을 지킬 수 없는 동안 전진이 막힙니다.
+    if (m_linkQuality.status().health == LinkHealth::BAD) {
+        return linkIntervalMs;
+    }
+    // 그 외에는 장애물 정지 루프의 입력이므로 지연 예산이 요구하는 최소 전송률을 유지합니다.
+    int obstacleIntervalMs = static_cast<int>(qMax<qint64>(1, m_obstacleGuard.maxPollIntervalUs() / 1000));
+    return qMin(linkIntervalMs, obstacleIntervalMs);
+}
+
+void RaspbotClient::updateSensorPollInterval() {
+    int interval = sensorPollIntervalMs();
+    if (m_sensorPollTimer->isActive() && m_sensorPollTimer->interval() != interval) {
+        m_sensorPollTimer->setInterval(interval);
+    }
+    // 폴링이 꺼져 있으면 새 샘플이 오지 않으므로 반응 한계에 주기를 넣지 않습니다.
+    m_obstacleGuard.setPollIntervalUs(m_sensorPollTimer->isActive() ? interval * 1000LL : 0);
+}
+
+void RaspbotClient::pollSensors() {
+    if (!isConnected()) return;
+
+    // 응답 손실이나 아래의 요청 생략으로 예산 동안 샘플이 없으면 정지합니다.
+    ObstacleAction action = m_obstacleGuard.onPollTick(clientTimeUs());
+    if (action != ObstacleAction::NONE) {
+        ObstacleEvent event;
+        applyObstacleAction(action, event);
+        reportObstacleEvent(event);
+    }
+
+    // 송신 대기열이 밀려 있으면 요청이 지연만 늘리므로 이번 주기는 보내지 않습니다.
+    if (isWriteCongested()) return;
+    requestUltrasonicDistance();
+    requestInfraredSensorData();
+}
+
+void RaspbotClient::evaluateLinkQuality() {
+    // 제한 시간 안에 응답이 오지 않은 동기화 요청은 손실로 처리
+    qint64 now = clientTimeUs();
+    while (!m_pendingSyncProbes.isEmpty() && now - m_pendingSyncProbes.first() > kProbeTimeoutUs) {
+        m_pendingSyncProbes.removeFirst();
+        m_linkQuality.addProbeResult(false);
+    }
+
+    updateWriteBacklog();
+    LinkStatus status = m_linkQuality.evaluate(m_writeBacklog.load());
+    m_controlIntervalMs = status.controlIntervalMs;
+    updateSensorPollInterval();
+    status.sensorIntervalMs = sensorPollIntervalMs();
+    emit linkStatusUpdated(status);
+}
+
+void RaspbotClient::sendTimeSyncRequest() {
+    if (!isConnected()) return;
+
+    // 직전 요청에 유효한 응답이 없었으면 요청 주기를 두 배씩 늘립니다.
+    // (동기화를 지원하지 않는 서버에 계속 요청을 보내지 않도록)
+    if (m_syncAwaitingReply) {
+        m_syncBackoff = qMin(m_syncBackoff + 1, kSyncMaxBackoff);
+    }
+
+    qint64 t0 = clientTimeUs();
+    QString cmd = CommandBuilder::buildTimeSyncCommand(t0);
+    if (sendCommand(cmd)) {
+        m_pendingSyncProbes.append(t0);
+        m_syncAwaitingReply = true;
+    }
+
+    int interval = m_clockSync.sampleCount() < kSyncFastSampleCount ? kSyncFastIntervalMs : kSyncIntervalMs;
+    interval <<= m_syncBackoff;
+    if (m_syncTimer->interval() != interval) {
+        m_syncTimer->setInterval(interval);
+    }
+}
+
+bool RaspbotClient::handleTimeSyncReply(const QJsonObject &reply, qint64 receivedUs) {
+    qint64 t0 = static_cast<qint64>(reply.value("t0").toDouble());
+    qint64 t1 = static_cast<qint64>(reply.value("t1").toDouble());
+    qint64 t2 = static_cast<qint64>(reply.value("t2").toDouble());
+
+    // 이미 손실로 처리된 요청의 늦은 응답은 시계 추정에만 사용합니다.
+    if (m_pendingSyncProbes.removeOne(t0)) {
+        m_linkQuality.addProbeResult(true);
+    }
+
+    if (!m_clockSync.addSample(t0, t1, t2, receivedUs)) {
+        return false;
+    }
+    m_syncAwaitingReply = false;
+    m_syncBackoff = 0;
+    m_linkQuality.addRoundTrip(m_clockSync.lastLatency().roundTripUs);
+    return true;
+}
+
 void RaspbotClient::onConnected() {
+    m_connected = true;
     qDebug() << "서버에 연결되었습니다.";
+    // 작은 정지 명령이 Nagle 알고리즘에 묶여 지연되지 않도록 합니다.
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_clockSync.reset();
+    m_linkQuality.reset();
+    m_obstacleGuard.reset();
+    m_obstacleStopActive = false;
+    m_controlIntervalMs = m_linkQuality.controlIntervalMs();
+    updateWriteBacklog();
+    m_pendingSyncProbes.clear();
+    m_syncAwaitingReply = false;
+    m_syncBackoff = 0;
+    m_syncTimer->start(kSyncFastIntervalMs);
+    m_linkTimer->start(kLinkEvaluationIntervalMs);
+    sendTimeSyncRequest(); // 첫 동기화 요청 즉시 전송
     emit connected();
 }
 
 void RaspbotClient::onDisconnected() {
+    m_connected = false;
     qDebug() << "서버와 연결이 끊겼습니다.";
+    m_syncTimer->stop();
+    m_linkTimer->stop();
+    m_sensorPollTimer->stop();
+    updateSensorPollInterval();
     emit disconnected();
 }
 
 void RaspbotClient::onReadyRead() {
+    // 이번에 도착한 데이터의 수신 시각 (t3)
+    qint64 receivedUs = clientTimeUs();
     m_readBuffer.append(m_socket->readAll());
+    processReadBuffer(receivedUs);
+}
+
+void RaspbotClient::onBytesWritten() {
+    updateWriteBacklog();
+}
+
+void RaspbotClient::processReadBuffer(qint64 receivedUs) {
+    struct Reply {
+        QByteArray line;
+        qint64 clientTimestampUs;
+    };
+    QVector<Reply> replies;
+    QVector<ObstacleEvent> obstacleEvents;
+    int validSyncReplies = 0;
+    int invalidSyncReplies = 0;
 
     // 라인 피드('\n')를 기준으로 메시지를 처리합니다.
+    // 이 루프에서는 장애물 판단과 정지 명령 송신만 하고, 시그널 발생과
+    // 로그 출력은 이번에 도착한 모든 줄을 처리한 뒤에 합니다.
     while (m_readBuffer.contains('\n')) {
         int newlineIndex = m_readBuffer.indexOf('\n');
         QByteArray line = m_readBuffer.left(newlineIndex).trimmed();
         m_readBuffer.remove(0, newlineIndex + 1);
 
-        QString response = QString::fromUtf8(line);
-        qDebug() << "서버로부터 메시지 수신:" << response;
-        emit messageReceived(response); // MainWindow로 전달
+        // 서버 타임스탬프가 있으면 클라이언트 시각으로 보정하고, 없으면 수신 시각을 사용합니다.
+        qint64 clientTimestampUs = receivedUs;
+        QJsonParseError jsonError;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &jsonError);
+        if (jsonError.error == QJsonParseError::NoError && doc.isObject()) {
+            QJsonObject obj = doc.object();
+            if (obj.value("command").toString() == "TIME_SYNC") {
+                // 동기화 응답은 내부에서만 처리
+                if (handleTimeSyncReply(obj, receivedUs)) {
+                    ++validSyncReplies;
+                } else {
+                    ++invalidSyncReplies;
+                }
+                continue;
+            }
+            if (obj.contains("timestamp") && m_clockSync.isSynchronized()) {
+                clientTimestampUs = toClientTime(static_cast<qint64>(obj.value("timestamp").toDouble()));
+            }
+            ObstacleEvent event;
+            if (checkObstacle(obj, clientTimestampUs, event)) {
+                obstacleEvents.append(event);
+            }
+        }
+        replies.append({line, clientTimestampUs});
+    }
+
+    // 여기서부터는 이미 정지 명령이 송신된 뒤의 보고 작업입니다.
+    if (invalidSyncReplies > 0) {
+        qWarning() << "잘못된 시계 동기화 응답:" << invalidSyncReplies << "건";
+    }
+    if (validSyncReplies > 0) {
+        emit latencyUpdated(m_clockSync.lastLatency());
+    }
+
+    for (const ObstacleEvent &event : obstacleEvents) {
+        reportObstacleEvent(event);
+    }
+
+    for (const Reply &reply : replies) {
+        // 응답 로그는 GUI 스레드(MainWindow)에서 남깁니다.
+        emit messageReceived(QString::fromUtf8(reply.line), reply.clientTimestampUs);
+    }
+}
+
+bool RaspbotClient::checkObstacle(const QJsonObject &reply, qint64 sampleTimeUs, ObstacleEvent &event) {
+    QString command = reply.value("command").toString();
+    ObstacleAction action = ObstacleAction::NONE;
+    if (command == "READ_ULTRASONIC" && reply.contains("distance")) {
+        action = m_obstacleGuard.onUltrasonicSample(reply.value("distance").toInt(), sampleTimeUs, clientTimeUs());
+    } else if (command == "READ_IR_SENSOR" && reply.contains("obstacle")) {
+        action = m_obstacleGuard.onInfraredSample(reply.value("obstacle").toBool(), sampleTimeUs, clientTimeUs());
+    }
+    if (action == ObstacleAction::NONE) {
+        return false;
+    }
+    applyObstacleAction(action, event);
+    return true;
+}
+
+void RaspbotClient::applyObstacleAction(ObstacleAction action, ObstacleEvent &event) {
+    event.action = action;
+    event.distanceCm = m_obstacleGuard.lastDistanceCm();
+    event.stopLatencyUs = 0;
+    event.reactionBoundUs = 0;
+    event.withinBudget = true;
+    event.staleSample = false;
+    event.stopWritten = false;
+
+    if (action == ObstacleAction::STOP) {
+        // 정지 상태를 먼저 알린 뒤 세대를 올립니다. GUI는 세대를 먼저 읽으므로
+        // 새 세대를 읽었다면 정지 상태도 반드시 보게 됩니다.
+        m_obstacleStopActive = true;
+        ++m_driveEpoch;
+        event.stopWritten = sendEmergencyStop();
+        event.withinBudget = m_obstacleGuard.recordStopSent(clientTimeUs());
+        event.staleSample = m_obstacleGuard.isTripStale();
+        event.stopLatencyUs = m_obstacleGuard.lastStopLatencyUs();
+        event.reactionBoundUs = m_obstacleGuard.lastReactionBoundUs();
+    } else {
+        m_obstacleStopActive = false;
+    }
+}
+
+void RaspbotClient::reportObstacleEvent(const ObstacleEvent &event) {
+    if (event.action == ObstacleAction::STOP) {
+        if (!event.stopWritten) {
+            qWarning() << "비상 정지 명령 쓰기 오류:" << m_socket->errorString();
+        }
+        if (!event.withinBudget) {
+            qWarning() << "장애물 반응 한계 예산 초과:" << event.reactionBoundUs << "us";
+        }
+        emit obstacleStopped(event.distanceCm, event.stopLatencyUs, event.reactionBoundUs, event.withinBudget, event.staleSample);
+    } else {
+        emit obstacleCleared();
     }
 }
 
+bool RaspbotClient::writeMotorUpdate(MotorDirection left, MotorDirection right, int speed) {
+    if (m_socket->state() != QTcpSocket::ConnectedState) return false;
+
+    // 네 모터 명령을 한 번의 쓰기로 보내고 즉시 소켓으로 밀어냅니다.
+    QByteArray data;
+    const MotorNumber motors[] = { MotorNumber::L1, MotorNumber::L2, MotorNumber::R1, MotorNumber::R2 };
+    for (MotorNumber motor : motors) {
+        MotorDirection direction = (motor == MotorNumber::L1 || motor == MotorNumber::L2) ? left : right;
+        data.append(CommandBuilder::buildMotorCommand(motor, direction, speed).toUtf8());
+        data.append('\n');
+    }
+    if (m_socket->write(data) == -1) {
+        return false;
+    }
+    m_socket->flush();
+    updateWriteBacklog();
+    return true;
+}
+
 void RaspbotClient::onErrorOccurred(QTcpSocket::SocketError socketError) {
+    {
+        QMutexLocker locker(&m_errorMutex);
+        m_errorString = m_socket->errorString();
+    }
     qWarning() << "소켓 오류 발생:" << socketError << "-" << m_socket->errorString();
     emit errorOccurred(socketError);
 }
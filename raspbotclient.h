@@ -6,8 +6,24 @@
 #include <QString>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QTimer>
+#include <atomic>
 #include "commandprotocol.h"
+#include "clocksync.h"
+#include "linkquality.h"
+#include "obstacleguard.h"
 
+/**
+ * 로봇 서버와의 TCP 통신을 담당하는 클라이언트입니다.
+ *
+ * 소켓, 타이머, 장애물 정지 판단은 모두 이 객체가 속한 스레드에서 동작합니다.
+ * MainWindow는 이 객체를 전용 스레드로 옮겨 사용하므로, 장애물 정지 루프가
+ * GUI 이벤트나 로그 출력 뒤에서 기다리지 않습니다.
+ * 공개 명령/설정 메소드는 다른 스레드에서 호출되면 클라이언트 스레드로 넘겨 실행하고,
+ * 상태 조회 메소드는 원자 변수로 갱신된 값을 돌려줍니다.
+ */
 class RaspbotClient : public QObject {
     Q_OBJECT
 
@@ -17,14 +33,19 @@ public:
 
     bool connectToServer(const QString &host, int port);
     void disconnectFromServer();
-    bool isConnected() const;
-    QString errorString() const { return m_socket->errorString(); }
+    bool isConnected() const { return m_connected.load(); }
+    QString errorString() const;
 
     // 명령어 전송 메소드
     bool sendCommand(const QString &command);
 
     // 직접 제어 메소드들 (CommandBuilder를 활용)
-    bool controlMotor(MotorNumber motor, MotorDirection direction, int speed);
+    // driveEpoch: 명령을 만든 시점의 주행 세대 (-1이면 현재 세대). 장애물 정지 이후에는
+    // 이전 세대에서 만들어진 주행 명령(속도 > 0)을 버립니다.
+    bool controlMotor(MotorNumber motor, MotorDirection direction, int speed, int driveEpoch = -1);
+    // 네 모터를 하나의 제어 갱신으로 한 번에 기록 (left: L1/L2, right: R1/R2 방향).
+    // 장애물 정지 중에는 전진 갱신(양쪽 FORWARD, 속도 > 0)을 클라이언트 스레드에서 거부합니다.
+    bool driveMotors(MotorDirection left, MotorDirection right, int speed, int driveEpoch = -1);
     bool controlServo(int servoNumber, int angle); // 1-2, 0-180도
     bool controlRgbAll(DeviceStatus status, RgbColor color);
     bool controlRgbIndividual(int ledNumber, DeviceStatus status, RgbColor color); // 1-14
@@ -39,23 +60,95 @@ public:
     void requestInfraredCodeValue();
     void requestKeyData();
 
+    // 시계 동기화 및 지연 측정
+    qint64 clientTimeUs() const { return m_clock.nsecsElapsed() / 1000; } // 클라이언트 단조 시계 (마이크로초)
+    qint64 toClientTime(qint64 serverTimeUs) const; // 서버 타임스탬프를 클라이언트 시각으로 보정 (클라이언트 스레드 전용)
+
+    // 링크 품질에 따른 전송률 조절
+    int controlIntervalMs() const { return m_controlIntervalMs.load(); } // 권장 제어 갱신 주기
+    bool isWriteCongested() const { return m_writeBacklog.load() > LinkQuality::backlogLimit(); } // 송신 대기열이 한도를 넘었는지 여부
+    void setSensorPollingEnabled(bool enabled); // 초음파/적외선 센서 주기적 요청
+    int sensorPollIntervalMs() const; // 센서 폴링 주기 (클라이언트 스레드 전용, 계산 방식은 구현 참고)
+
+    // 장애물 정지 루프
+    void setObstacleStopDistance(int distanceCm);
+    void setObstacleLatencyBudget(int budgetMs); // 반응 한계 예산 (센서 폴링 최소 전송률도 함께 결정)
+    bool isObstacleStopActive() const { return m_obstacleStopActive.load(); }
+    int driveEpoch() const { return m_driveEpoch.load(); } // 장애물 정지마다 증가하는 주행 세대
+
 signals:
     void connected();
     void disconnected();
     void errorOccurred(QTcpSocket::SocketError socketError);
-    void messageReceived(const QString &message); // 서버 응답 메시지
+    void messageReceived(const QString &message, qint64 clientTimestampUs); // 서버 응답 메시지와 클라이언트 기준 시각
+    void latencyUpdated(const LinkLatency &latency); // 시계 동기화 교환마다 갱신된 구간별 지연
+    void linkStatusUpdated(const LinkStatus &status); // 링크 품질 평가 결과
+    // 장애물 정지 명령 전송 후 (stopLatencyUs: 샘플 측정→송신, reactionBoundUs: 여기에 폴링 주기를 더한 반응 한계,
+    // staleSample: 장애물이 아니라 센서 샘플이 예산 안에 오지 않아 정지한 경우)
+    void obstacleStopped(int distanceCm, qint64 stopLatencyUs, qint64 reactionBoundUs, bool withinBudget, bool staleSample);
+    void obstacleCleared(); // 장애물 정지 해제
 
 private slots:
     void onConnected();
     void onDisconnected();
     void onReadyRead();
+    void onBytesWritten();
     void onErrorOccurred(QTcpSocket::SocketError socketError);
+    void sendTimeSyncRequest();
+    void evaluateLinkQuality();
+    void pollSensors();
 
 private:
+    friend class RaspbotBenchmark;
+
+    // 이번 수신 묶음에서 발생한 장애물 판단 결과 (신호와 로그는 묶음 처리 후에 내보냄)
+    struct ObstacleEvent {
+        ObstacleAction action;
+        int distanceCm;
+        qint64 stopLatencyUs;
+        qint64 reactionBoundUs;
+        bool withinBudget;
+        bool staleSample;
+        bool stopWritten;
+    };
+
+    bool isClientThread() const;
+    void processReadBuffer(qint64 receivedUs); // 버퍼에 쌓인 완성된 줄 단위 메시지 처리
+    bool handleTimeSyncReply(const QJsonObject &reply, qint64 receivedUs); // 유효한 샘플이면 true
+    bool checkObstacle(const QJsonObject &reply, qint64 sampleTimeUs, ObstacleEvent &event); // 센서 응답으로 장애물 판단
+    void applyObstacleAction(ObstacleAction action, ObstacleEvent &event); // 정지 명령 송신 및 상태 갱신
+    void reportObstacleEvent(const ObstacleEvent &event); // 로그와 시그널 (정지 명령 송신 이후에만 호출)
+    bool writeMotorUpdate(MotorDirection left, MotorDirection right, int speed); // 네 모터 명령을 한 번의 쓰기로 기록
+    bool sendEmergencyStop() { return writeMotorUpdate(MotorDirection::FORWARD, MotorDirection::FORWARD, 0); }
+    void updateSensorPollInterval(); // 폴링 타이머 주기와 반응 한계 계산용 주기 갱신
+    void updateWriteBacklog() { m_writeBacklog = m_socket->bytesToWrite(); }
+
     QTcpSocket *m_socket;
     QString m_host;
     int m_port;
     QByteArray m_readBuffer; // 수신 데이터 버퍼
+
+    QElapsedTimer m_clock;  // 클라이언트 기준 시계
+    ClockSync m_clockSync;  // 서버 시계 오프셋/드리프트 추정기
+    QTimer *m_syncTimer;    // 주기적 시계 동기화 요청 타이머
+    bool m_syncAwaitingReply; // 마지막 동기화 요청에 유효한 응답을 아직 받지 못했는지
+    int m_syncBackoff;        // 무응답이 이어질 때의 요청 주기 배수 (2^n)
+
+    LinkQuality m_linkQuality;          // RTT/대기열/손실 기반 전송률 조절기
+    QTimer *m_linkTimer;                // 링크 품질 평가 타이머
+    QTimer *m_sensorPollTimer;          // 센서 폴링 타이머
+    QList<qint64> m_pendingSyncProbes;  // 응답을 기다리는 동기화 요청의 t0
+
+    ObstacleGuard m_obstacleGuard;      // 센서 기반 장애물 정지 판단기
+
+    // 다른 스레드에서 읽는 상태
+    std::atomic<bool> m_connected;
+    std::atomic<qint64> m_writeBacklog;
+    std::atomic<int> m_controlIntervalMs;
+    std::atomic<bool> m_obstacleStopActive;
+    std::atomic<int> m_driveEpoch;
+    mutable QMutex m_errorMutex;
+    QString m_errorString;
 };
 
 #endif // RASPBOTCLIENT_H
@@ -0,0 +1,20 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++17 testcase console
+
+TARGET = tst_raspbotcore
+TEMPLATE = app
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    tst_raspbotcore.cpp \
+    ../clocksync.cpp \
+    ../linkquality.cpp \
+    ../obstacleguard.cpp
+
+HEADERS += \
+    ../clocksync.h \
+    ../linkquality.h \
+    ../obstacleguard.h
@@ -0,0 +1,328 @@
+#include <QtTest>
+
+#include "clocksync.h"
+#include "linkquality.h"
+#include "obstacleguard.h"
+
+/**
+ * 시계 동기화, 링크 품질 조절, 장애물 정지 판단의 동작 테스트입니다.
+ * 세 클래스 모두 소켓이나 위젯 없이 시각 값만으로 구동됩니다.
+ *
+ *   qmake tests/tests.pro && make && ./tst_raspbotcore
+ */
+
+namespace {
+
+constexpr qint64 kMs = 1000; // 마이크로초 단위 시각 계산용
+
+// 테스트용 기본 설정: 정지 거리 20 cm, 예산 100 ms, 폴링 주기 20 ms
+ObstacleGuard makeGuard() {
+    ObstacleGuard guard;
+    guard.setStopDistanceCm(20);
+    guard.setLatencyBudgetUs(100 * kMs);
+    guard.setPollIntervalUs(20 * kMs);
+    return guard;
+}
+
+} // namespace
+
+class RaspbotCoreTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    // ClockSync
+    void clockSplitsSymmetricExchange();
+    void clockKeepsMinimumDelayOffset();
+    void clockRejectsNegativeDelay();
+    void clockEstimatesDrift();
+
+    // LinkQuality
+    void linkInactiveUntilFirstRoundTrip();
+    void linkDecreasesOnLoss();
+    void linkIncreasesUpToMaximum();
+    void linkBacklogFullIsBad();
+    void linkRatesStayAboveMinimum();
+
+    // ObstacleGuard
+    void obstacleTripsBelowStopDistance();
+    void obstacleReleasesOnlyAboveHysteresis();
+    void obstacleStaleSampleFailsSafe();
+    void obstacleMissingSamplesFailSafe();
+    void obstacleInfraredTrips();
+    void obstacleIgnoresInvalidDistance_data();
+    void obstacleIgnoresInvalidDistance();
+    void obstacleCountsBudgetViolations();
+};
+
+void RaspbotCoreTest::clockSplitsSymmetricExchange() {
+    ClockSync clock;
+    const qint64 offset = 5000 * kMs; // 서버 시계가 5초 앞섬
+
+    // 업링크 3 ms, 서버 처리 1 ms, 다운링크 3 ms
+    const qint64 t0 = 1000 * kMs;
+    const qint64 t1 = t0 + 3 * kMs + offset;
+    const qint64 t2 = t1 + 1 * kMs;
+    const qint64 t3 = t0 + 7 * kMs;
+    QVERIFY(clock.addSample(t0, t1, t2, t3));
+    QVERIFY(clock.isSynchronized());
+
+    const LinkLatency latency = clock.lastLatency();
+    QCOMPARE(latency.offsetUs, offset);
+    QCOMPARE(latency.roundTripUs, 6 * kMs);
+    QCOMPARE(latency.serverProcessingUs, 1 * kMs);
+    QCOMPARE(latency.uplinkUs, 3 * kMs);
+    QCOMPARE(latency.downlinkUs, 3 * kMs);
+    QCOMPARE(clock.toClientTime(t1), t0 + 3 * kMs);
+}
+
+void RaspbotCoreTest::clockKeepsMinimumDelayOffset() {
+    ClockSync clock;
+    const qint64 offset = 5000 * kMs;
+
+    qint64 t0 = 1000 * kMs;
+    QVERIFY(clock.addSample(t0, t0 + 3 * kMs + offset, t0 + 4 * kMs + offset, t0 + 7 * kMs));
+
+    // 업링크에 17 ms 큐잉이 더해진 교환: 오프셋은 최소 지연 샘플 기준으로 유지되고
+    // 늘어난 지연은 업링크 쪽 추정치로 나타남
+    t0 = 2000 * kMs;
+    QVERIFY(clock.addSample(t0, t0 + 20 * kMs + offset, t0 + 21 * kMs + offset, t0 + 24 * kMs));
+
+    const LinkLatency latency = clock.lastLatency();
+    QCOMPARE(latency.offsetUs, offset);
+    QCOMPARE(latency.roundTripUs, 23 * kMs);
+    QCOMPARE(latency.uplinkUs, 20 * kMs);
+    QCOMPARE(latency.downlinkUs, 3 * kMs);
+}
+
+void RaspbotCoreTest::clockRejectsNegativeDelay() {
+    ClockSync clock;
+    const qint64 t0 = 1000 * kMs;
+
+    // 서버 처리 시간이 왕복 시간보다 긴 응답
+    QVERIFY(!clock.addSample(t0, t0 + 1 * kMs, t0 + 10 * kMs, t0 + 2 * kMs));
+    // 서버 송신 시각이 수신 시각보다 앞선 응답
+    QVERIFY(!clock.addSample(t0, t0 + 5 * kMs, t0 + 4 * kMs, t0 + 10 * kMs));
+
+    QVERIFY(!clock.isSynchronized());
+    QCOMPARE(clock.sampleCount(), 0);
+}
+
+void RaspbotCoreTest::clockEstimatesDrift() {
+    ClockSync clock;
+    const qint64 offset = 5000 * kMs;
+    const double driftPpm = 100.0;
+
+    // 1초 간격, 대칭 지연 2 ms로 30초 동안 교환
+    for (int i = 0; i < 30; ++i) {
+        const qint64 t0 = (1000 + i * 1000) * kMs;
+        const qint64 serverOffset = offset + static_cast<qint64>(driftPpm * 1e-6 * (t0 + 1 * kMs));
+        const qint64 t1 = t0 + 1 * kMs + serverOffset;
+        QVERIFY(clock.addSample(t0, t1, t1, t0 + 2 * kMs));
+    }
+
+    QVERIFY(qAbs(clock.driftPpm() - driftPpm) < 1.0);
+}
+
+void RaspbotCoreTest::linkInactiveUntilFirstRoundTrip() {
+    LinkQuality link;
+    const int initialControlMs = link.controlIntervalMs();
+    const int initialSensorMs = link.sensorIntervalMs();
+
+    // 동기화를 지원하지 않는 서버: 무응답을 손실로 세지 않고 전송률도 유지
+    for (int i = 0; i < 10; ++i) {
+        link.addProbeResult(false);
+        LinkStatus status = link.evaluate(0);
+        QCOMPARE(status.health, LinkHealth::UNKNOWN);
+        QCOMPARE(status.lossRate, 0.0);
+    }
+    QVERIFY(!link.isActive());
+    QCOMPARE(link.controlIntervalMs(), initialControlMs);
+    QCOMPARE(link.sensorIntervalMs(), initialSensorMs);
+
+    link.addRoundTrip(5 * kMs);
+    QVERIFY(link.isActive());
+    QCOMPARE(link.evaluate(0).health, LinkHealth::GOOD);
+}
+
+void RaspbotCoreTest::linkDecreasesOnLoss() {
+    LinkQuality link;
+    link.addRoundTrip(5 * kMs);
+    const int controlMs = link.controlIntervalMs();   // 100 Hz
+    const int sensorMs = link.sensorIntervalMs();     // 10 Hz
+
+    link.addProbeResult(false);
+    LinkStatus status = link.evaluate(0);
+    QCOMPARE(status.health, LinkHealth::DEGRADED);
+    QCOMPARE(status.controlIntervalMs, 20); // 100 Hz -> 50 Hz
+    QCOMPARE(status.sensorIntervalMs, 200); // 10 Hz -> 5 Hz
+    QVERIFY(status.controlIntervalMs > controlMs);
+    QVERIFY(status.sensorIntervalMs > sensorMs);
+
+    // 손실은 한 번의 평가에만 반영되고, 다음 평가에서는 다시 증가
+    QCOMPARE(link.evaluate(0).controlIntervalMs, 17); // 60 Hz
+}
+
+void RaspbotCoreTest::linkIncreasesUpToMaximum() {
+    LinkQuality link;
+    link.addRoundTrip(5 * kMs);
+
+    for (int i = 0; i < 50; ++i) {
+        QCOMPARE(link.evaluate(0).health, LinkHealth::GOOD);
+    }
+    QCOMPARE(link.controlIntervalMs(), 5); // 200 Hz
+    QCOMPARE(link.sensorIntervalMs(), 50); // 20 Hz
+}
+
+void RaspbotCoreTest::linkBacklogFullIsBad() {
+    LinkQuality link;
+    link.addRoundTrip(5 * kMs);
+
+    LinkStatus status = link.evaluate(LinkQuality::backlogLimit() + 1);
+    QCOMPARE(status.health, LinkHealth::BAD);
+    QCOMPARE(status.controlIntervalMs, 20);
+    QCOMPARE(status.writeBacklog, LinkQuality::backlogLimit() + 1);
+}
+
+void RaspbotCoreTest::linkRatesStayAboveMinimum() {
+    LinkQuality link;
+    link.addRoundTrip(5 * kMs);
+
+    for (int i = 0; i < 20; ++i) {
+        link.addProbeResult(false);
+        link.evaluate(0);
+    }
+    QCOMPARE(link.status().health, LinkHealth::BAD);
+    QCOMPARE(link.controlIntervalMs(), 100); // 10 Hz 하한
+    QCOMPARE(link.sensorIntervalMs(), 500);  // 2 Hz 하한
+}
+
+void RaspbotCoreTest::obstacleTripsBelowStopDistance() {
+    ObstacleGuard guard = makeGuard();
+    const qint64 now = 1000 * kMs;
+
+    QCOMPARE(guard.onUltrasonicSample(50, now, now), ObstacleAction::NONE);
+    QCOMPARE(guard.onUltrasonicSample(20, now, now), ObstacleAction::NONE); // 정지 거리와 같으면 정지하지 않음
+    QVERIFY(!guard.isTripped());
+
+    QCOMPARE(guard.onUltrasonicSample(19, now, now), ObstacleAction::STOP);
+    QVERIFY(guard.isTripped());
+    QVERIFY(!guard.isTripStale());
+    QCOMPARE(guard.lastDistanceCm(), 19);
+
+    // 정지 상태에서 더 가까운 값이 와도 정지 명령을 다시 내지 않음
+    QCOMPARE(guard.onUltrasonicSample(10, now, now), ObstacleAction::NONE);
+}
+
+void RaspbotCoreTest::obstacleReleasesOnlyAboveHysteresis() {
+    ObstacleGuard guard = makeGuard();
+    const qint64 now = 1000 * kMs;
+
+    QCOMPARE(guard.onUltrasonicSample(10, now, now), ObstacleAction::STOP);
+    QCOMPARE(guard.onUltrasonicSample(21, now, now), ObstacleAction::NONE);
+    QCOMPARE(guard.onUltrasonicSample(25, now, now), ObstacleAction::NONE); // 정지 거리 + 5 cm는 아직 해제 안 됨
+    QVERIFY(guard.isTripped());
+
+    QCOMPARE(guard.onUltrasonicSample(26, now, now), ObstacleAction::RELEASE);
+    QVERIFY(!guard.isTripped());
+}
+
+void RaspbotCoreTest::obstacleStaleSampleFailsSafe() {
+    ObstacleGuard guard = makeGuard();
+    const qint64 now = 1000 * kMs;
+
+    // 샘플 나이 80 ms + 폴링 주기 20 ms = 예산 100 ms: 아직 유효
+    QCOMPARE(guard.onUltrasonicSample(200, now - 80 * kMs, now), ObstacleAction::NONE);
+    // 샘플 나이 81 ms: 먼 거리라도 예산을 지킬 수 없으므로 정지
+    QCOMPARE(guard.onUltrasonicSample(200, now - 81 * kMs, now), ObstacleAction::STOP);
+    QVERIFY(guard.isTripped());
+    QVERIFY(guard.isTripStale());
+
+    // 오래된 샘플로는 해제하지 않고, 예산 안의 새 샘플로만 해제
+    QCOMPARE(guard.onUltrasonicSample(200, now - 90 * kMs, now), ObstacleAction::NONE);
+    QCOMPARE(guard.onUltrasonicSample(200, now - 10 * kMs, now), ObstacleAction::RELEASE);
+}
+
+void RaspbotCoreTest::obstacleMissingSamplesFailSafe() {
+    ObstacleGuard guard = makeGuard();
+    const qint64 now = 1000 * kMs;
+
+    // 아직 샘플이 없으면 (센서 미지원일 수 있음) 판단하지 않음
+    QCOMPARE(guard.onPollTick(now), ObstacleAction::NONE);
+
+    QCOMPARE(guard.onUltrasonicSample(200, now, now), ObstacleAction::NONE);
+    QCOMPARE(guard.onPollTick(now + 100 * kMs), ObstacleAction::NONE);
+    // 예산 동안 새 샘플이 없으면 (응답 손실, 혼잡으로 폴링 생략) 정지
+    QCOMPARE(guard.onPollTick(now + 101 * kMs), ObstacleAction::STOP);
+    QVERIFY(guard.isTripStale());
+
+    QCOMPARE(guard.onUltrasonicSample(200, now + 120 * kMs, now + 120 * kMs), ObstacleAction::RELEASE);
+}
+
+void RaspbotCoreTest::obstacleInfraredTrips() {
+    ObstacleGuard guard = makeGuard();
+    const qint64 now = 1000 * kMs;
+
+    QCOMPARE(guard.onInfraredSample(false, now, now), ObstacleAction::NONE);
+    QCOMPARE(guard.onInfraredSample(true, now, now), ObstacleAction::STOP);
+
+    // 초음파가 멀어도 적외선이 장애물을 보고 있으면 해제하지 않음
+    QCOMPARE(guard.onUltrasonicSample(200, now, now), ObstacleAction::NONE);
+    QVERIFY(guard.isTripped());
+
+    QCOMPARE(guard.onInfraredSample(false, now, now), ObstacleAction::RELEASE);
+}
+
+void RaspbotCoreTest::obstacleIgnoresInvalidDistance_data() {
+    QTest::addColumn<int>("distanceCm");
+
+    QTest::newRow("zero") << 0;
+    QTest::newRow("negative") << -1;
+}
+
+void RaspbotCoreTest::obstacleIgnoresInvalidDistance() {
+    QFETCH(int, distanceCm);
+
+    ObstacleGuard guard = makeGuard();
+    const qint64 now = 1000 * kMs;
+
+    // 측정 실패 값은 정지 거리보다 작아도 장애물이 아님
+    QCOMPARE(guard.onUltrasonicSample(distanceCm, now, now), ObstacleAction::NONE);
+    QVERIFY(!guard.isTripped());
+
+    // 정지 상태를 해제하는 근거도 되지 않음
+    QCOMPARE(guard.onUltrasonicSample(10, now, now), ObstacleAction::STOP);
+    QCOMPARE(guard.onUltrasonicSample(distanceCm, now, now), ObstacleAction::NONE);
+    QVERIFY(guard.isTripped());
+}
+
+void RaspbotCoreTest::obstacleCountsBudgetViolations() {
+    ObstacleGuard guard = makeGuard();
+    QCOMPARE(guard.maxPollIntervalUs(), 50 * kMs);
+
+    // 샘플 측정 → 송신 50 ms, 폴링 주기 20 ms를 더한 반응 한계 70 ms: 예산 안
+    qint64 sampleTime = 1000 * kMs;
+    QCOMPARE(guard.onUltrasonicSample(10, sampleTime, sampleTime), ObstacleAction::STOP);
+    QVERIFY(guard.recordStopSent(sampleTime + 50 * kMs));
+    QCOMPARE(guard.lastStopLatencyUs(), 50 * kMs);
+    QCOMPARE(guard.lastReactionBoundUs(), 70 * kMs);
+    QCOMPARE(guard.budgetViolations(), 0);
+
+    QCOMPARE(guard.onUltrasonicSample(200, sampleTime + 60 * kMs, sampleTime + 60 * kMs), ObstacleAction::RELEASE);
+
+    // 송신까지 90 ms: 반응 한계 110 ms로 예산 초과
+    sampleTime = 2000 * kMs;
+    QCOMPARE(guard.onUltrasonicSample(10, sampleTime, sampleTime), ObstacleAction::STOP);
+    QVERIFY(!guard.recordStopSent(sampleTime + 90 * kMs));
+    QCOMPARE(guard.lastReactionBoundUs(), 110 * kMs);
+    QCOMPARE(guard.maxStopLatencyUs(), 90 * kMs);
+    QCOMPARE(guard.budgetViolations(), 1);
+
+    // reset은 통계만 지우고 설정은 유지
+    guard.reset();
+    QCOMPARE(guard.budgetViolations(), 0);
+    QCOMPARE(guard.latencyBudgetUs(), 100 * kMs);
+}
+
+QTEST_APPLESS_MAIN(RaspbotCoreTest)
+
+#include "tst_raspbotcore.moc"